@@ -0,0 +1,58 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+// A minimal harness for engine_bench. Benchmarks register with
+// BENCHMARK(name) { ... } and time their variants with measure(), which
+// prints the best of a few rounds in nanoseconds per operation.
+
+using BenchFunction = void (*)();
+
+struct BenchEntry {
+  const char *name;
+  BenchFunction function;
+};
+
+inline std::vector<BenchEntry> &bench_registry() {
+  static std::vector<BenchEntry> s_entries;
+  return s_entries;
+}
+
+inline bool register_bench(const char *name, BenchFunction function) {
+  bench_registry().push_back({name, function});
+  return true;
+}
+
+#define BENCHMARK(name)                                                        \
+  static void name();                                                          \
+  static const bool name##_registered = register_bench(#name, name);           \
+  static void name()
+
+// Keeps the compiler from optimizing away a result the benchmark computes.
+template <typename T> void keep(const T &value) {
+  static volatile T s_sink;
+  s_sink = value;
+  (void)s_sink;
+}
+
+// Runs `body` (which performs `operations` operations) once to warm up,
+// then ROUNDS more times, and reports the fastest round.
+template <typename Func>
+void measure(const char *label, size_t operations, Func &&body) {
+  constexpr int ROUNDS = 5;
+  body();
+  double best_ns = 0.0;
+  for (int round = 0; round < ROUNDS; ++round) {
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    const auto end = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(end - start)
+                          .count();
+    best_ns = round == 0 ? ns : std::min(best_ns, ns);
+  }
+  std::printf("  %-44s %10.2f ns/op\n", label,
+              best_ns / static_cast<double>(operations));
+}
@@ -0,0 +1,89 @@
+#include "Bench.h"
+#include "core/events/EventDispatcher.h"
+#include "core/events/KeyEvent.h"
+#include "core/events/MouseEvent.h"
+#include <functional>
+#include <map>
+#include <typeindex>
+#include <unordered_map>
+
+namespace {
+constexpr size_t EVENTS = 2000000;
+constexpr int SUBSCRIBERS = 32;
+// Events posted per dispatch_events(); stays under EventQueue::CAPACITY.
+constexpr size_t BATCH = 4000;
+
+// The dispatcher before flat subscriber tables: a hash map from type to an
+// ordered map of std::functions, each wrapping the typed callback.
+class MapDispatcher {
+public:
+  template <typename T, typename Func> void subscribe(Func callback) {
+    std::function<void(T &)> typed = std::move(callback);
+    m_subscribers[typeid(T)][m_next_handle++] = [typed](Event &event) {
+      typed(static_cast<T &>(event));
+    };
+  }
+
+  void dispatch(Event &event) {
+    auto it = m_subscribers.find(typeid(event));
+    if (it == m_subscribers.end()) {
+      return;
+    }
+    for (const auto &[handle, callback] : it->second) {
+      callback(event);
+      if (event.handled) {
+        break;
+      }
+    }
+  }
+
+private:
+  std::unordered_map<std::type_index,
+                     std::map<uint64_t, std::function<void(Event &)>>>
+      m_subscribers;
+  uint64_t m_next_handle = 0;
+};
+} // namespace
+
+// Two million events, each delivered to 32 subscribers.
+BENCHMARK(event_dispatch) {
+  long total = 0;
+  std::vector<ScopedSubscription> subscriptions;
+  for (int i = 0; i < SUBSCRIBERS; ++i) {
+    subscriptions.push_back(EventDispatcher::subscribe<MouseMovedEvent>(
+        [&total](MouseMovedEvent &event) {
+          total += static_cast<long>(event.get_x());
+        }));
+    subscriptions.push_back(EventDispatcher::subscribe<KeyPressedEvent>(
+        [&total](KeyPressedEvent &event) { total += event.get_key_code(); }));
+  }
+  MapDispatcher map_dispatcher;
+  for (int i = 0; i < SUBSCRIBERS; ++i) {
+    map_dispatcher.subscribe<MouseMovedEvent>(
+        [&total](MouseMovedEvent &event) {
+          total += static_cast<long>(event.get_x());
+        });
+  }
+
+  MouseMovedEvent moved(1.0f, 2.0f, 0.0f, 0.0f);
+  measure("map of std::function (old), per event", EVENTS, [&] {
+    for (size_t i = 0; i < EVENTS; ++i) {
+      map_dispatcher.dispatch(moved);
+    }
+  });
+  measure("EventDispatcher::dispatch, per event", EVENTS, [&] {
+    for (size_t i = 0; i < EVENTS; ++i) {
+      EventDispatcher::dispatch(moved);
+    }
+  });
+  // Key events are KeepAll, so every posted event is delivered.
+  measure("post + dispatch_events, per event", EVENTS, [&] {
+    for (size_t done = 0; done < EVENTS; done += BATCH) {
+      for (size_t i = 0; i < BATCH; ++i) {
+        EventDispatcher::post<KeyPressedEvent>(1);
+      }
+      EventDispatcher::dispatch_events();
+    }
+  });
+  keep(total);
+}
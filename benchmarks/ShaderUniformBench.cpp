@@ -0,0 +1,51 @@
+#include "Bench.h"
+#include "core/Window.h"
+#include "graphics/Shader.h"
+#include <glad/glad.h>
+#include <string>
+
+namespace {
+constexpr size_t CALLS = 1000000;
+
+// How every setter resolved its uniform before handles: the driver looks the
+// name up on each call.
+void set_int_by_location(unsigned int program, const std::string &name,
+                         int value) {
+  glUniform1i(glGetUniformLocation(program, name.c_str()), value);
+}
+} // namespace
+
+// Setting one uniform a million times through each path.
+BENCHMARK(shader_uniforms) {
+  Window window;
+  if (!window.init_headless(64, 64, 0)) {
+    std::printf("  skipped: no headless OpenGL context\n");
+    return;
+  }
+  Shader shader(ShaderType::Graphics,
+                {"shaders/shader.vert", "shaders/shader.frag"});
+  shader.use();
+
+  measure("glGetUniformLocation per call (old)", CALLS, [&] {
+    for (size_t i = 0; i < CALLS; ++i) {
+      set_int_by_location(shader.get_id(), "u_texture", 0);
+    }
+  });
+  measure("set_int(std::string), hashed lookup", CALLS, [&] {
+    for (size_t i = 0; i < CALLS; ++i) {
+      shader.set_int("u_texture", 0);
+    }
+  });
+  static constexpr UniformName U_TEXTURE("u_texture");
+  measure("get_uniform(UniformName) per call", CALLS, [&] {
+    for (size_t i = 0; i < CALLS; ++i) {
+      shader.set_int(shader.get_uniform(U_TEXTURE), 0);
+    }
+  });
+  const UniformHandle texture = shader.get_uniform(U_TEXTURE);
+  measure("set_int(UniformHandle), resolved once", CALLS, [&] {
+    for (size_t i = 0; i < CALLS; ++i) {
+      shader.set_int(texture, 0);
+    }
+  });
+}
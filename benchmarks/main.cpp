@@ -0,0 +1,16 @@
+#include "Bench.h"
+#include <cstring>
+
+// Runs every benchmark, or only those whose name contains argv[1]. Run from
+// the source root so GL benchmarks find shaders/.
+int main(int argc, char **argv) {
+  const char *filter = argc > 1 ? argv[1] : nullptr;
+  for (const BenchEntry &entry : bench_registry()) {
+    if (filter && !std::strstr(entry.name, filter)) {
+      continue;
+    }
+    std::printf("%s\n", entry.name);
+    entry.function();
+  }
+  return 0;
+}
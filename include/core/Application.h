@@ -15,10 +15,13 @@ class Event;
 class KeyPressedEvent;
 struct ScriptingContext;
 class DebugConsole;
+class FrameCapture;
+class EventRecorder;
 
 class Application {
 public:
-  Application();
+  // `arguments` are the command-line arguments after the program name.
+  explicit Application(std::vector<std::string> arguments = {});
   ~Application();
 
   // Initializes all components and starts the main render loop.
@@ -36,6 +39,9 @@ private:
   std::unique_ptr<Scene> m_active_scene;
   std::unique_ptr<ScriptingContext> m_scripting_context;
   std::unique_ptr<DebugConsole> m_console;
+  std::unique_ptr<FrameCapture> m_capture;
+  std::unique_ptr<EventRecorder> m_recorder;
+  std::vector<std::string> m_arguments;
   std::vector<ScopedSubscription> m_subscriptions;
 
   std::mutex m_command_mutex;
@@ -1,6 +1,8 @@
 #pragma once
+#include "core/events/EventDispatcher.h"
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
+#include <vector>
 
 class Window;
 
@@ -18,9 +20,12 @@ public:
   bool is_key_released(int key) const;
 
 private:
-  void key_callback_impl(int key, int action);
+  void set_key_state(int key, bool down);
 
   bool m_current_key_states[GLFW_KEY_LAST + 1] = {false};
   bool m_previous_key_states[GLFW_KEY_LAST + 1] = {false};
   GLFWwindow *m_window; // Keep a pointer to the window
+  // Key state follows dispatched key events, so replayed input (see
+  // EventRecorder) drives polling too.
+  std::vector<ScopedSubscription> m_subscriptions;
 };
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+
+// An engine-wide work-stealing thread pool. Every worker owns a queue; idle
+// workers steal from the others, and the thread that submits work helps out
+// until it is done.
+class JobSystem {
+public:
+  // This class is not meant to be instantiated.
+  JobSystem() = delete;
+
+  // Starts `worker_count` worker threads. 0 picks one per hardware thread,
+  // minus the calling thread.
+  static void init(unsigned int worker_count);
+  // Stops and joins all workers.
+  static void shutdown();
+
+  static unsigned int get_worker_count();
+
+  // Splits [0, count) into chunks of at most `chunk_size` and calls
+  // func(begin, end) for each chunk, possibly on several threads at once.
+  // Blocks until every chunk has run. Runs inline when there are no workers
+  // or the range fits in one chunk.
+  template <typename Func>
+  static void parallel_for(size_t count, size_t chunk_size, Func &&func) {
+    using FuncType = std::remove_reference_t<Func>;
+    run_chunks(
+        count, chunk_size,
+        [](void *context, size_t begin, size_t end) {
+          (*static_cast<FuncType *>(context))(begin, end);
+        },
+        const_cast<void *>(static_cast<const void *>(&func)));
+  }
+
+  // Type-erased chunk callback used by parallel_for.
+  using ChunkFunction = void (*)(void *context, size_t begin, size_t end);
+
+private:
+  static void run_chunks(size_t count, size_t chunk_size,
+                         ChunkFunction function, void *context);
+};
@@ -3,9 +3,11 @@
 // Forward declarations of the systems we want to expose to Lua
 class Scene;
 class IRenderer;
+class FrameCapture;
 
 struct ScriptingContext {
   Scene *scene = nullptr;
   IRenderer *renderer = nullptr;
+  FrameCapture *capture = nullptr;
   // AudioEngine* audioEngine = nullptr;
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 // A simple struct to hold our application's configuration.
 struct Config {
@@ -10,7 +11,27 @@ struct Config {
   bool window_resizable = true;
   bool window_transparent = false;
   float fps = 60.0f;
+  unsigned int worker_threads = 0; // 0 = one per hardware thread, minus main
+  // Scene updates per second, independent of the frame rate (0 = one
+  // variable-length update per frame), and the most run in one frame
+  float fixed_update_hz = 0.0f;
+  unsigned int max_fixed_steps = 5;
   std::string window_title = "OpenGL Application";
+  // Render offscreen without a window or input (CI, batch jobs)
+  bool headless = false;
+  unsigned int headless_frames = 0; // Frames to run; 0 = until closed
+  // Frame capture from the start of the run (--capture N on the command line)
+  unsigned int capture_frames = 0; // 0 = no capture
+  std::string capture_format = "png"; // "png", "raw" or "y4m"
+  std::string capture_path = "capture";
+  // Write GpuProfiler results as JSON here on exit (--gpu-profile <path>)
+  std::string gpu_profile_path;
+  // Write a Chrome trace of the CPU profiler's zones on exit (--cpu-trace)
+  std::string cpu_trace_path;
+  // Record dispatched input to this log (--record), or replay one at a
+  // fixed timestep instead of taking live input (--replay)
+  std::string record_path;
+  std::string replay_path;
 
   // Runtime-configurable settings loaded from Lua
   std::string renderer_type = "graphics";
@@ -18,6 +39,9 @@ struct Config {
   // For GraphicsRenderer
   std::string graphics_main_shader_name = "default";
   std::string graphics_canvas_shader_name = "canvas";
+  // Cull and draw mesh objects on the GPU (compute + multi-draw indirect)
+  bool graphics_gpu_driven = false;
+  std::string graphics_cull_shader_name = "cull";
 
   // For CanvasRenderer
   std::string canvas_shader_name = "canvas";
@@ -33,6 +57,11 @@ public:
   Settings();
   // Loads settings from the specified file path.
   bool load(const std::string &filepath);
+  // Applies command-line overrides (arguments after the program name):
+  //   --capture <frames>  --capture-format <png|raw|y4m>
+  //   --capture-path <path without extension>  --gpu-profile <json path>
+  //   --cpu-trace <json path>  --record <log path>  --replay <log path>
+  void apply_arguments(const std::vector<std::string> &arguments);
   // Provides access to the loaded configuration.
   const Config &get_config() const;
   Config &get_mutable_config();
@@ -1,9 +1,29 @@
 #pragma once
+#include <cstdint>
 
+// The master clock counts integer nanosecond ticks on a monotonic clock, so
+// it never loses precision however long the app runs; seconds are derived
+// from ticks as doubles.
+//
+// Simulation updates either follow the frame (variable delta) or, with
+// set_fixed_update(), run at a fixed rate decoupled from rendering:
+//
+//   Time::begin_frame();
+//   while (Time::next_fixed_step()) {
+//     update(Time::get_fixed_delta());
+//   }
+//   render(Time::get_interpolation_alpha());
 class Time {
 public:
   static void init(float target_fps);
 
+  // Runs the simulation at `hz` steps per second (0 = once per frame with
+  // the frame's delta). When frames fall behind, at most `max_steps` steps
+  // run per frame and the rest are dropped, so a heavy scene slows down
+  // instead of spiraling.
+  static void set_fixed_update(double hz, unsigned int max_steps);
+  static bool is_fixed_update() { return s_fixed_step_ticks > 0; }
+
   // Call at the beginning of the frame.
   // Calculates delta time and updates the FPS counter.
   static void begin_frame();
@@ -12,24 +32,61 @@ public:
   // Sleeps if necessary to cap the frame rate.
   static void end_frame();
 
+  // Fixed update only: returns true while another step is due this frame,
+  // advancing the simulation clock by one step each time.
+  static bool next_fixed_step();
+
   // Returns the time in seconds it took to complete the last frame.
   static double get_delta_time() { return s_delta_time; }
 
-  static double get_total_time() { return s_total_time; }
+  static double get_total_time() { return ticks_to_seconds(s_total_ticks); }
+
+  // Seconds per fixed step.
+  static double get_fixed_delta() {
+    return ticks_to_seconds(s_fixed_step_ticks);
+  }
+  // The time the simulation has reached: the end of the last fixed step, or
+  // the total time without fixed update.
+  static double get_simulation_time() {
+    return is_fixed_update() ? ticks_to_seconds(s_simulation_ticks)
+                             : get_total_time();
+  }
+  // How far rendering is between the last two fixed steps, in [0, 1). Blend
+  // the previous and current simulation state by it for smooth motion.
+  static float get_interpolation_alpha();
+
+  // When enabled, every frame reports a delta of exactly 1 / target fps
+  // whatever the wall clock says, so a run is reproducible (e.g. replays).
+  static void set_fixed_step(bool enabled) { s_fixed_step = enabled; }
 
 private:
   Time() = default;
   static void update_fps();
 
+  static constexpr int64_t TICKS_PER_SECOND = 1000000000;
+
+  static double ticks_to_seconds(int64_t ticks) {
+    return static_cast<double>(ticks) / TICKS_PER_SECOND;
+  }
+
   static float s_target_fps;
-  static double s_target_frame_time;
-  static double s_frame_start_time;
-  static double s_last_frame_time;
+  static int64_t s_target_frame_ticks;
+  static int64_t s_frame_start_ticks;
+  static int64_t s_last_frame_ticks;
   static double s_delta_time;
-  static double s_total_time;
+  static int64_t s_total_ticks;
+  static bool s_fixed_step;
+
+  // Fixed update
+  static int64_t s_fixed_step_ticks; // 0 = disabled
+  static unsigned int s_max_steps;
+  static unsigned int s_steps_this_frame;
+  static int64_t s_accumulator_ticks; // Frame time not yet simulated
+  static int64_t s_simulation_ticks;
+  static int s_dropped_steps_count;
 
   // For FPS calculation
-  static double s_last_fps_time;
+  static int64_t s_last_fps_ticks;
   static int s_frame_count;
 
   static int s_missed_frames_count; // NOTE: Potentially to be removed if
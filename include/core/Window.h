@@ -13,6 +13,12 @@ public:
   // Initializes GLFW, creates a window, and initializes GLAD.
   bool init(unsigned int width, unsigned int height, const char *title,
             bool resizable, bool transparent);
+  // Creates a surfaceless EGL context instead of a window and binds an
+  // offscreen framebuffer of the given size, so rendering works with no
+  // display. The window reports should_close() after `max_frames` swaps
+  // (0 = never). Needs a build with EGL (HAS_EGL).
+  bool init_headless(unsigned int width, unsigned int height,
+                     unsigned int max_frames);
 
   // Checks if the window has been flagged to close.
   bool should_close();
@@ -31,16 +37,42 @@ public:
 
   GLFWwindow *get_glfw_window() const { return m_window; }
 
+  bool is_headless() const { return m_headless != nullptr; }
+  // The framebuffer rendering goes to: the offscreen one when headless,
+  // otherwise 0.
+  unsigned int get_framebuffer() const { return m_framebuffer; }
+
 private:
   static void framebuffer_size_callback(GLFWwindow *window, int width,
                                         int height);
+  static void cursor_position_callback(GLFWwindow *window, double xpos,
+                                       double ypos);
 
   void on_resize(int width, int height);
 
+  // EGL objects of a headless context, defined in Window.cpp
+  struct HeadlessContext;
+
+  bool create_offscreen_framebuffer();
+
   GLFWwindow *m_window = nullptr;
+  std::unique_ptr<HeadlessContext> m_headless;
   std::unique_ptr<Input>
       m_input_handler; // The window now owns the input handler
   //
   unsigned int m_width = 0;
   unsigned int m_height = 0;
+
+  // Last cursor position, for MouseMovedEvent deltas
+  double m_cursor_x = 0.0;
+  double m_cursor_y = 0.0;
+  bool m_has_cursor = false;
+
+  // Headless state
+  unsigned int m_framebuffer = 0;
+  unsigned int m_color_renderbuffer = 0;
+  unsigned int m_depth_renderbuffer = 0;
+  unsigned int m_max_frames = 0;
+  unsigned int m_frame_count = 0;
+  bool m_should_close = false;
 };
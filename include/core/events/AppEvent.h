@@ -15,6 +15,8 @@ public:
   }
 
   EVENT_CLASS_TYPE(WindowResize)
+  // Only the final size of a drag matters.
+  EVENT_CLASS_COALESCING(KeepLatest)
 
   std::string to_string() const override {
     return "WindowResizeEvent: " + std::to_string(m_width) + ", " +
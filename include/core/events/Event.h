@@ -1,18 +1,38 @@
 #pragma once
 
+#include "utils/Hash.h"
+#include <cstdint>
 #include <string>
 
 // A simple enum to classify events into broad categories.
 // This is useful for future filtering.
 enum class EventCategory { None = 0, Application, Input, Keyboard, Mouse };
 
+// How several events of one type queued in the same frame are combined
+// before dispatch.
+enum class EventCoalescing {
+  KeepAll,        // Every event is dispatched (the default)
+  KeepLatest,     // Only the newest one is dispatched
+  AccumulateDelta // The newest one is dispatched after accumulate()-ing the
+                  // older ones into it
+};
+
 // This macro is a handy way to implement the necessary virtual functions
-// for identifying an event's type at runtime.
+// for identifying an event's type at runtime. STATIC_TYPE_ID is a hash of
+// the type name, known at compile time.
 #define EVENT_CLASS_TYPE(type)                                                 \
+  static constexpr uint32_t STATIC_TYPE_ID = Hash::fnv1a(#type);               \
   static const char *get_static_type() { return #type; }                       \
   virtual const char *get_type_name() const override {                         \
     return get_static_type();                                                  \
-  }
+  }                                                                            \
+  virtual uint32_t get_type_id() const override { return STATIC_TYPE_ID; }
+
+// Declares the coalescing policy of an event class, e.g.
+// EVENT_CLASS_COALESCING(KeepLatest). Classes without one keep every event.
+#define EVENT_CLASS_COALESCING(policy)                                         \
+  static constexpr EventCoalescing COALESCING = EventCoalescing::policy;       \
+  virtual EventCoalescing get_coalescing() const override { return COALESCING; }
 
 class Event {
 public:
@@ -21,6 +41,14 @@ public:
   bool handled = false;
 
   virtual const char *get_type_name() const = 0;
+  virtual uint32_t get_type_id() const = 0;
   virtual EventCategory get_category() const = 0;
   virtual std::string to_string() const { return get_type_name(); }
+
+  virtual EventCoalescing get_coalescing() const {
+    return EventCoalescing::KeepAll;
+  }
+  // AccumulateDelta only: folds an older event of the same type into this
+  // one.
+  virtual void accumulate(const Event &older) {}
 };
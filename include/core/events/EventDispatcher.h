@@ -1,12 +1,11 @@
 #pragma once
 
 #include "core/events/Event.h"
+#include "core/events/EventQueue.h"
+#include "utils/Delegate.h"
 #include <cstdint>
-#include <functional>
-#include <map>
-#include <memory>
-#include <typeindex>
-#include <unordered_map>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 // FORWARD DECLARE EventDispatcher to be used by ScopedSubscription
@@ -34,52 +33,97 @@ private:
   friend class EventDispatcher;
   using SubscriptionHandle = uint64_t;
 
-  ScopedSubscription(SubscriptionHandle handle, std::type_index type_index);
+  ScopedSubscription(SubscriptionHandle handle, uint32_t event_id);
 
   void reset(); // Helper to release ownership
 
   SubscriptionHandle m_handle = -1; // -1 represents an invalid handle
-  std::type_index m_type_index = typeid(void);
+  uint32_t m_event_id = 0;
 };
 
 class EventDispatcher {
 public:
   using SubscriptionHandle = uint64_t;
+  using Callback = Delegate<void(Event &)>;
+  // Sees each queued event before its subscribers; returning false drops it.
+  using Hook = Delegate<bool(const Event &)>;
 
   EventDispatcher() = delete;
 
-  // CHANGE: subscribe now returns our RAII wrapper
-  template <typename T>
-  static ScopedSubscription subscribe(std::function<void(T &)> callback) {
-    static SubscriptionHandle s_next_subscription_id = 0;
-    SubscriptionHandle handle = s_next_subscription_id++;
-    std::type_index type_index(typeid(T));
-
-    auto wrapper = [callback](Event &event) {
-      callback(static_cast<T &>(event));
-    };
-
-    s_subscribers[type_index][handle] = wrapper;
+  // Calls callback(T &) for every dispatched T, in subscription order, until
+  // one marks the event handled. Subscribing from inside a handler takes
+  // effect after the current dispatch.
+  template <typename T, typename Func>
+  static ScopedSubscription subscribe(Func &&callback) {
+    static_assert(std::is_base_of_v<Event, T>, "Subscribe to Event types");
+    const SubscriptionHandle handle = s_next_handle++;
+    add_subscriber(T::STATIC_TYPE_ID, T::get_static_type(), handle,
+                   Callback([callback = std::forward<Func>(callback)](
+                                Event &event) mutable {
+                     callback(static_cast<T &>(event));
+                   }));
     // Return the RAII object which now owns the subscription
-    return ScopedSubscription(handle, type_index);
+    return ScopedSubscription(handle, T::STATIC_TYPE_ID);
   }
 
-  // Queues an event for later processing.
-  static void queue_event(std::unique_ptr<Event> event);
-  // Dispatches all queued events to subscribers.
+  // Queues a T built from `args` for the next dispatch_events(). Safe from
+  // any thread and never allocates; returns false if the queue is full.
+  template <typename T, typename... Args> static bool post(Args &&...args) {
+    return s_event_queue.push<T>(std::forward<Args>(args)...);
+  }
+  // Dispatches all queued events to subscribers, first coalescing each
+  // type by its EventCoalescing policy. Main thread only, as are subscribe
+  // and unsubscribe.
   static void dispatch_events();
+  // Delivers one event to its subscribers right away. Main thread only.
+  static void dispatch(Event &event);
+  // Installs the hook dispatch_events() runs on each event after
+  // coalescing (e.g. to record them); an empty Hook removes it.
+  static void set_hook(Hook hook) { s_hook = std::move(hook); }
 
 private:
   friend class ScopedSubscription; // Allow access to unsubscribe
 
-  // CHANGE: unsubscribe is now private and non-templated
-  static void unsubscribe(SubscriptionHandle handle,
-                          std::type_index type_index);
-
-  static std::unordered_map<
-      std::type_index,
-      std::map<SubscriptionHandle, std::function<void(Event &)>>>
-      s_subscribers;
-
-  static std::vector<std::unique_ptr<Event>> s_event_queue;
+  static constexpr SubscriptionHandle INVALID_HANDLE = ~SubscriptionHandle(0);
+
+  // Subscribers of one event type as dense parallel arrays, so a dispatch
+  // is a linear walk over delegates.
+  struct SubscriberTable {
+    uint32_t event_id = 0;
+    const char *event_name = nullptr;
+    std::vector<Callback> callbacks;
+    // INVALID_HANDLE marks an entry unsubscribed during a dispatch; it is
+    // skipped, then removed once the dispatch is over.
+    std::vector<SubscriptionHandle> handles;
+    bool has_holes = false;
+  };
+
+  struct PendingSubscriber {
+    uint32_t event_id;
+    const char *event_name;
+    SubscriptionHandle handle;
+    Callback callback;
+  };
+
+  static void add_subscriber(uint32_t event_id, const char *event_name,
+                             SubscriptionHandle handle, Callback callback);
+  static void unsubscribe(SubscriptionHandle handle, uint32_t event_id);
+  static SubscriberTable *find_table(uint32_t event_id);
+  // Applies subscription changes deferred while dispatching.
+  static void apply_pending();
+  // Nulls out the events of a batch superseded by a newer one of the same
+  // type with no KeepAll event in between, folding them into it where the
+  // type accumulates.
+  static void coalesce(std::vector<Event *> &batch);
+
+  static std::vector<SubscriberTable> s_tables; // Sorted by event_id
+  static std::vector<PendingSubscriber> s_pending;
+  static unsigned int s_dispatch_depth;
+  static SubscriptionHandle s_next_handle;
+  static Hook s_hook;
+
+  static EventQueue s_event_queue;
+  static std::vector<Event *> s_batch; // Reused by dispatch_events
+  // Newest event per coalescing type while walking a batch
+  static std::vector<Event *> s_latest;
 };
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "core/events/Event.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bounded multi-producer, single-consumer queue of events stored inline.
+// Any thread may push; one thread (the main thread) consumes. Every slot
+// holds one event constructed in place, so pushing never allocates and the
+// queue's memory is allocated once.
+//
+// Slots are handed over with per-slot sequence numbers (Vyukov's bounded
+// queue): a slot is free for the producer claiming position `pos` when its
+// sequence is `pos`, and holds a published event when it is `pos + 1`.
+class EventQueue {
+public:
+  static constexpr size_t CAPACITY = 4096; // Must be a power of two
+  // Largest event that fits in a slot: a vtable pointer, `handled` and 32
+  // bytes of payload (e.g. one std::string).
+  static constexpr size_t MAX_EVENT_SIZE = 48;
+  static constexpr size_t MAX_EVENT_ALIGN = alignof(std::max_align_t);
+
+  EventQueue();
+  ~EventQueue();
+
+  EventQueue(const EventQueue &) = delete;
+  EventQueue &operator=(const EventQueue &) = delete;
+
+  // Constructs a T and queues it. Returns false (and counts a drop) if the
+  // queue is full.
+  template <typename T, typename... Args> bool push(Args &&...args) {
+    static_assert(std::is_base_of_v<Event, T>, "Queued types must be Events");
+    static_assert(sizeof(T) <= MAX_EVENT_SIZE && alignof(T) <= MAX_EVENT_ALIGN,
+                  "Event is too large to store inline in an EventQueue slot");
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "Events must be nothrow move-constructible");
+    // Construct first, so a throwing constructor never leaves a claimed
+    // slot unpublished.
+    T event(std::forward<Args>(args)...);
+    size_t pos;
+    Slot *slot = claim(pos);
+    if (!slot) {
+      return false;
+    }
+    slot->event = new (slot->storage) T(std::move(event));
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Calls func(Event &) on each event published before the call, oldest
+  // first, destroying each afterwards. Events pushed meanwhile (e.g. by a
+  // handler) wait for the next call. Consumer thread only.
+  template <typename Func> size_t consume(Func &&func) {
+    const size_t end = m_enqueue_pos.load(std::memory_order_acquire);
+    size_t count = 0;
+    while (m_dequeue_pos != end) {
+      Slot &slot = m_slots[m_dequeue_pos & MASK];
+      // A producer claimed this position but hasn't finished writing it;
+      // keep order and pick it up next time.
+      if (slot.sequence.load(std::memory_order_acquire) !=
+          m_dequeue_pos + 1) {
+        break;
+      }
+      func(*slot.event);
+      release(slot);
+      count++;
+    }
+    return count;
+  }
+
+  // Like consume, but hands func the whole batch at once as a
+  // std::vector<Event *> (reusing `batch`'s storage), so it can look ahead
+  // before the events are destroyed. func may null out entries but must not
+  // resize the vector. Consumer thread only.
+  template <typename Func>
+  size_t consume_batch(std::vector<Event *> &batch, Func &&func) {
+    const size_t end = m_enqueue_pos.load(std::memory_order_acquire);
+    const size_t begin = m_dequeue_pos;
+    batch.clear();
+    for (size_t pos = begin; pos != end; ++pos) {
+      Slot &slot = m_slots[pos & MASK];
+      if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+        break;
+      }
+      batch.push_back(slot.event);
+    }
+    const size_t count = batch.size();
+    func(batch);
+    for (size_t i = 0; i < count; ++i) {
+      release(m_slots[m_dequeue_pos & MASK]);
+    }
+    return count;
+  }
+
+  // Events dropped because the queue was full since the last call.
+  size_t take_dropped_count() {
+    return m_dropped.exchange(0, std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr size_t MASK = CAPACITY - 1;
+  static_assert((CAPACITY & MASK) == 0, "CAPACITY must be a power of two");
+
+  // One cache line per slot, so producers don't share lines.
+  struct alignas(64) Slot {
+    std::atomic<size_t> sequence{0};
+    Event *event = nullptr; // Event base of the object in `storage`
+    alignas(MAX_EVENT_ALIGN) unsigned char storage[MAX_EVENT_SIZE];
+  };
+
+  // Reserves the next position for a producer, or returns nullptr if full.
+  Slot *claim(size_t &pos);
+  // Destroys the slot's event and hands the slot to the next lap.
+  void release(Slot &slot);
+
+  std::unique_ptr<Slot[]> m_slots;
+  alignas(64) std::atomic<size_t> m_enqueue_pos{0};
+  alignas(64) size_t m_dequeue_pos = 0; // Consumer only
+  std::atomic<size_t> m_dropped{0};
+};
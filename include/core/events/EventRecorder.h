@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class Event;
+
+// Records the input events dispatch_events() delivers, tagged with the frame
+// they were dispatched in, and replays such a log: each frame its events are
+// dispatched again and live input is dropped, so an interactive session can
+// be rerun as a repeatable benchmark. Replays run Time at a fixed step.
+//
+// Log format (little-endian): a Header, then one record per event:
+//   frame delta since the previous record (LEB128 varint)
+//   event type id (uint32, Event::get_type_id())
+//   the event's fields (fixed size per type, see EventRecorder.cpp)
+class EventRecorder {
+public:
+  EventRecorder() = default;
+  ~EventRecorder();
+
+  EventRecorder(const EventRecorder &) = delete;
+  EventRecorder &operator=(const EventRecorder &) = delete;
+
+  // `fps` is stored in the log and becomes the replay's fixed step.
+  bool start_recording(const std::string &path, float fps);
+  // Loads the whole log up front so replaying never touches the disk.
+  // Returns the recorded fps in `fps`.
+  bool start_replay(const std::string &path, float &fps);
+  // Finishes the log or ends the replay.
+  void stop();
+
+  // Call once a frame, right after EventDispatcher::dispatch_events().
+  // Replaying, dispatches this frame's recorded events.
+  void end_dispatch();
+
+  bool is_recording() const { return m_mode == Mode::Recording; }
+  bool is_replaying() const { return m_mode == Mode::Replaying; }
+  // True once a replay has reached the last recorded frame.
+  bool is_replay_finished() const {
+    return m_mode == Mode::Replaying && m_frame >= m_frame_count;
+  }
+
+private:
+  enum class Mode { Idle, Recording, Replaying };
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    float fps;
+    uint32_t frame_count; // Patched in when recording stops
+  };
+
+  static constexpr char MAGIC[4] = {'E', 'V', 'R', 'C'};
+  static constexpr uint32_t VERSION = 1;
+  // Recorded bytes kept in memory before they are written out
+  static constexpr size_t FLUSH_SIZE = 64 * 1024;
+
+  // Appends `event` to the log if its type is recordable.
+  void record(const Event &event);
+  void flush();
+  // Reads the frame delta of the record at m_read_pos.
+  void read_next_frame();
+
+  Mode m_mode = Mode::Idle;
+  uint32_t m_frame = 0;
+  uint32_t m_frame_count = 0;
+  uint32_t m_last_record_frame = 0;
+
+  // Recording
+  std::ofstream m_file;
+  std::vector<unsigned char> m_buffer;
+
+  // Replaying: the records, and the read position and frame of the next one
+  std::vector<unsigned char> m_log;
+  size_t m_read_pos = 0;
+  uint32_t m_next_frame = 0;
+  bool m_has_next = false;
+};
@@ -1,18 +1,32 @@
 #pragma once
 #include "core/events/Event.h"
 
+// Cursor position, plus the motion since the previous MouseMovedEvent.
+// Moves queued in one frame coalesce into one event at the latest position
+// carrying the summed motion.
 class MouseMovedEvent : public Event {
 public:
-  MouseMovedEvent(float x, float y) : m_mouse_x(x), m_mouse_y(y) {}
+  MouseMovedEvent(float x, float y, float delta_x, float delta_y)
+      : m_mouse_x(x), m_mouse_y(y), m_delta_x(delta_x), m_delta_y(delta_y) {}
 
   float get_x() const { return m_mouse_x; }
   float get_y() const { return m_mouse_y; }
+  float get_delta_x() const { return m_delta_x; }
+  float get_delta_y() const { return m_delta_y; }
 
   EventCategory get_category() const override { return EventCategory::Mouse; }
   EVENT_CLASS_TYPE(MouseMoved)
+  EVENT_CLASS_COALESCING(AccumulateDelta)
+
+  void accumulate(const Event &older) override {
+    const auto &moved = static_cast<const MouseMovedEvent &>(older);
+    m_delta_x += moved.m_delta_x;
+    m_delta_y += moved.m_delta_y;
+  }
 
 private:
   float m_mouse_x, m_mouse_y;
+  float m_delta_x, m_delta_y;
 };
 
 // Base class for mouse button events.
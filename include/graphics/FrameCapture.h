@@ -0,0 +1,116 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class CaptureFormat {
+  Png, // One <path>_00000.png per frame
+  Raw, // RGBA8 frames, top row first, appended to <path>.rgba
+  Y4m, // YUV 4:4:4 video in <path>.y4m, e.g. for ffmpeg
+};
+
+// Dumps rendered frames to disk without stalling the pipeline. Each frame's
+// pixels are read into one of RING_SIZE pixel-pack buffers; glReadPixels
+// into a buffer returns at once and the copy happens on the GPU. A buffer is
+// mapped a frame or two later, once its fence has signaled, and the pixels
+// go to a background thread that encodes and writes them.
+class FrameCapture {
+public:
+  static constexpr unsigned int RING_SIZE = 3;
+  // Frames waiting for the encoder before capture() blocks on it, so a slow
+  // disk bounds memory instead of growing it.
+  static constexpr size_t MAX_QUEUED_FRAMES = 8;
+
+  FrameCapture();
+  // Waits for the encoder. Call shutdown() first while the GL context is
+  // still current.
+  ~FrameCapture();
+
+  FrameCapture(const FrameCapture &) = delete;
+  FrameCapture &operator=(const FrameCapture &) = delete;
+
+  // "png", "raw" or "y4m".
+  static bool parse_format(const std::string &name, CaptureFormat &format);
+
+  // Captures the next `frame_count` frames (0 = until stop()). `path` is the
+  // output file name without extension. `fps` goes in Y4M headers.
+  bool start(unsigned int frame_count, CaptureFormat format,
+             const std::string &path, unsigned int fps = 60);
+  // Ends the capture, waiting for readbacks still in flight.
+  void stop();
+  // True from start() until the last frame has been handed to the encoder.
+  bool is_capturing() const { return m_session_open; }
+
+  // Call once a frame after rendering, before overlays and the buffer swap.
+  // Queues a readback of `framebuffer`'s color (0 = default back buffer)
+  // and passes finished readbacks on to the encoder.
+  void capture(unsigned int framebuffer, unsigned int width,
+               unsigned int height);
+
+  // Stops any capture and deletes the GL buffers. Needs the GL context.
+  void shutdown();
+
+private:
+  struct Slot {
+    unsigned int buffer = 0;
+    size_t capacity = 0;
+    void *fence = nullptr; // GLsync
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int frame = 0;
+    bool pending = false;
+  };
+
+  struct Job {
+    std::vector<unsigned char> pixels;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int frame = 0;
+    CaptureFormat format = CaptureFormat::Png;
+    std::string path;
+    unsigned int fps = 60;
+    bool finish = false; // Closes the stream; carries no pixels
+  };
+
+  // Hands slots to the encoder oldest first. Stops at the first slot whose
+  // readback is still running unless `wait` is set.
+  void collect(bool wait);
+  void read_slot(Slot &slot);
+  void finish_session();
+  void push_job(Job job);
+
+  // Encoder thread
+  void worker_loop();
+  void encode(Job &job);
+
+  Slot m_slots[RING_SIZE];
+  unsigned int m_next_slot = 0; // Oldest pending slot, next one to reuse
+
+  bool m_session_open = false;
+  bool m_reading = false; // Still issuing readbacks
+  unsigned int m_frames_requested = 0;
+  unsigned int m_frames_issued = 0;
+  CaptureFormat m_format = CaptureFormat::Png;
+  std::string m_path;
+  unsigned int m_fps = 60;
+  unsigned int m_stream_width = 0;
+  unsigned int m_stream_height = 0;
+
+  std::thread m_worker;
+  std::mutex m_mutex;
+  std::condition_variable m_job_ready;
+  std::condition_variable m_job_taken;
+  std::deque<Job> m_jobs;
+  // Pixel buffers the encoder is done with, reused to avoid reallocating.
+  std::vector<std::vector<unsigned char>> m_spare_pixels;
+  bool m_quit = false;
+
+  // Encoder thread only
+  std::ofstream m_stream;
+  unsigned int m_frames_written = 0;
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// Per-frame data shared by every shader through one std140 uniform buffer.
+// Shaders opt in by declaring the block below; Shader binds any block named
+// BLOCK_NAME to BINDING when it links, so no shader sets these by name.
+//
+//   layout (std140) uniform FrameData {
+//     mat4 u_view;
+//     mat4 u_projection;
+//     mat4 u_view_projection;
+//     vec2 u_resolution; // Framebuffer size in pixels
+//     float u_time;      // Seconds since start
+//     float u_delta_time;
+//   };
+class FrameUniforms {
+public:
+  // This class is not meant to be instantiated.
+  FrameUniforms() = delete;
+
+  static constexpr unsigned int BINDING = 0;
+  static constexpr const char *BLOCK_NAME = "FrameData";
+
+  // Mirrors the GLSL block under std140 rules.
+  struct Data {
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::mat4 view_projection = glm::mat4(1.0f);
+    glm::vec2 resolution = glm::vec2(0.0f);
+    float time = 0.0f;
+    float delta_time = 0.0f;
+  };
+
+  // Creates the buffer and binds it. Needs a current GL context.
+  static void init();
+  static void shutdown();
+
+  // Uploads the timing and resolution fields. Call once per frame before
+  // any rendering; the camera fields keep their previous values.
+  static void begin_frame(float time, float delta_time, unsigned int width,
+                          unsigned int height);
+  // Uploads the camera fields for the rest of the frame.
+  static void set_camera(const glm::mat4 &view, const glm::mat4 &projection);
+
+  static const Data &get_data() { return s_data; }
+
+private:
+  static Data s_data;
+  static unsigned int s_buffer;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// A world-space bounding sphere: xyz is the center, w the radius.
+using BoundingSphere = glm::vec4;
+
+// An axis-aligned box.
+struct Aabb {
+  glm::vec3 min = glm::vec3(0.0f);
+  glm::vec3 max = glm::vec3(0.0f);
+
+  static Aabb from_sphere(const BoundingSphere &sphere) {
+    const glm::vec3 center(sphere);
+    return Aabb{center - glm::vec3(sphere.w), center + glm::vec3(sphere.w)};
+  }
+  // Half the surface area; enough to compare boxes for SAH.
+  float half_area() const {
+    const glm::vec3 e = max - min;
+    return e.x * e.y + e.y * e.z + e.z * e.x;
+  }
+};
+
+// The six clip planes of a camera, each stored as (normal, distance) with the
+// normal pointing into the frustum, so a point p is inside when
+// dot(normal, p) + distance >= 0 for every plane.
+struct Frustum {
+  enum Containment { OUTSIDE, INTERSECTING, INSIDE };
+
+  enum Plane {
+    PLANE_LEFT,
+    PLANE_RIGHT,
+    PLANE_BOTTOM,
+    PLANE_TOP,
+    PLANE_NEAR,
+    PLANE_FAR,
+    PLANE_COUNT
+  };
+
+  glm::vec4 planes[PLANE_COUNT];
+
+  // Extracts the planes from a projection * view matrix.
+  static Frustum from_matrix(const glm::mat4 &view_projection);
+
+  // Classifies a box against the frustum. Like the sphere test it is
+  // conservative: some boxes outside near the corners report INTERSECTING.
+  Containment test(const Aabb &box) const;
+
+  // Writes 1 to visible[i] if spheres[i] intersects the frustum, else 0.
+  // Tests four spheres per plane at a time where SSE is available. The test
+  // is conservative: a sphere near a frustum corner can pass while lying
+  // just outside.
+  void cull_spheres(const BoundingSphere *spheres, size_t count,
+                    uint8_t *visible) const;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+// Shadows the OpenGL bindings the engine changes most often (program, vertex
+// array, 2D textures) so redundant binds never reach the driver. Every such
+// bind and delete must go through here, or the cache goes stale; call
+// invalidate() after code that changes them behind its back.
+class GLState {
+public:
+  // This class is not meant to be instantiated.
+  GLState() = delete;
+
+  static constexpr unsigned int MAX_TEXTURE_UNITS = 16;
+
+  static void use_program(unsigned int program);
+  static void bind_vertex_array(unsigned int vertex_array);
+  // Binds `texture` to GL_TEXTURE_2D of texture unit `unit`.
+  static void bind_texture(unsigned int unit, unsigned int texture);
+
+  // Deleting a bound object silently rebinds 0, and the name may be reused.
+  static void delete_program(unsigned int program);
+  static void delete_vertex_array(unsigned int vertex_array);
+  static void delete_texture(unsigned int texture);
+
+  // Forgets everything; the next bind of each kind always reaches GL.
+  static void invalidate();
+
+private:
+  static unsigned int s_program;
+  static unsigned int s_vertex_array;
+  static unsigned int s_active_unit;
+  static unsigned int s_textures[MAX_TEXTURE_UNITS];
+};
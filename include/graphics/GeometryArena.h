@@ -0,0 +1,104 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Vertex;
+
+// Where a mesh's geometry lives inside the GeometryArena.
+struct GeometrySlice {
+  uint32_t base_vertex = 0;
+  uint32_t vertex_count = 0;
+  uint32_t first_index = 0;
+  uint32_t index_count = 0;
+  // The arena's buffers this slice was allocated from. Slices from before a
+  // shutdown() must not free ranges of the buffers created after it.
+  uint32_t generation = 0;
+
+  bool is_valid() const { return vertex_count > 0; }
+};
+
+// One vertex buffer and one index buffer shared by every Mesh, with a
+// single VAO over them. Meshes own slices (base vertex, first index)
+// instead of their own buffers, so drawing any mesh needs the same VAO and
+// any set of meshes can go into one multi-draw.
+//
+// Both buffers are sub-allocated first-fit from a free list and grow on
+// demand; growing copies the old contents on the GPU, so slices stay valid.
+// Needs a current GL context for everything except release().
+class GeometryArena {
+public:
+  // This class is not meant to be instantiated.
+  GeometryArena() = delete;
+
+  // VAO layout: per-vertex attributes 0-2 read binding VERTEX_BINDING,
+  // per-instance mat4 attributes 3-6 read binding INSTANCE_BINDING.
+  static constexpr unsigned int VERTEX_BINDING = 0;
+  static constexpr unsigned int INSTANCE_BINDING = 1;
+
+  // Uploads the geometry. Returns an invalid slice if there is none.
+  static GeometrySlice allocate(const Vertex *vertices, uint32_t vertex_count,
+                                const unsigned int *indices,
+                                uint32_t index_count);
+  // Returns the slice's space to the free lists. CPU-only, so it is safe to
+  // call after shutdown(); slices from before a shutdown() are ignored.
+  static void release(const GeometrySlice &slice);
+
+  // The shared VAO, created on first use.
+  static unsigned int get_vertex_array();
+  // Points the VAO's instance attributes at `buffer` and leaves the VAO
+  // bound.
+  static void bind_instance_buffer(unsigned int buffer);
+
+  // Frees the GPU objects. Slices handed out before become meaningless.
+  static void shutdown();
+
+  static uint32_t get_vertex_capacity() { return s_vertices.capacity(); }
+  static uint32_t get_index_capacity() { return s_indices.capacity(); }
+
+private:
+  static constexpr uint32_t INITIAL_VERTEX_CAPACITY = 64 * 1024;
+  static constexpr uint32_t INITIAL_INDEX_CAPACITY = 192 * 1024;
+
+  // First-fit allocator over [0, capacity) elements.
+  class RangeAllocator {
+  public:
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    void reset(uint32_t capacity);
+    // Extends the range to `capacity` elements.
+    void grow(uint32_t capacity);
+    uint32_t allocate(uint32_t count);
+    void release(uint32_t offset, uint32_t count);
+    uint32_t capacity() const { return m_capacity; }
+
+  private:
+    struct Range {
+      uint32_t offset;
+      uint32_t count;
+    };
+    // Sorted by offset; neighbours are never adjacent (they get merged).
+    std::vector<Range> m_free;
+    uint32_t m_capacity = 0;
+  };
+
+  static bool create();
+  // Grows a buffer to at least `min_capacity` elements of `element_size`.
+  static void grow(unsigned int &buffer, RangeAllocator &allocator,
+                   uint32_t min_capacity, size_t element_size);
+  // Reattaches the buffers to the VAO after one was replaced.
+  static void attach_buffers();
+  static uint32_t allocate_range(unsigned int &buffer,
+                                 RangeAllocator &allocator, uint32_t count,
+                                 size_t element_size);
+
+  static unsigned int s_vao;
+  static unsigned int s_vbo;
+  static unsigned int s_ebo;
+  // One identity matrix, the instance data of non-instanced draws
+  static unsigned int s_identity_instance;
+  static RangeAllocator s_vertices;
+  static RangeAllocator s_indices;
+  // Bumped every time create() makes new buffers
+  static uint32_t s_generation;
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Measures GPU time per render pass with timestamp queries. Results are
+// read FRAME_LATENCY frames later, once the GPU has long finished them, so
+// profiling never waits on the GPU; frames whose results are still missing
+// are skipped instead. Each pass keeps a rolling window of per-frame times.
+//
+// Passes nest (timestamps, unlike GL_TIME_ELAPSED queries, can overlap),
+// and a pass entered several times in one frame reports the sum.
+//
+//   GpuProfiler::Scope scope("scene");
+class GpuProfiler {
+public:
+  // This class is not meant to be instantiated.
+  GpuProfiler() = delete;
+
+  static constexpr unsigned int FRAME_LATENCY = 3;
+  static constexpr unsigned int HISTORY_SIZE = 120; // Frames per window
+
+  struct PassStats {
+    std::string name;
+    unsigned int depth = 0; // Nesting level; the frame itself is 0
+    float last_ms = 0.0f;
+    float min_ms = 0.0f;
+    float avg_ms = 0.0f;
+    float max_ms = 0.0f;
+    unsigned int samples = 0; // Frames in the window
+  };
+
+  class Scope {
+  public:
+    explicit Scope(const char *name) { begin_pass(name); }
+    ~Scope() { end_pass(); }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+  };
+
+  // Deletes the query objects. Needs the GL context.
+  static void shutdown();
+
+  static void set_enabled(bool enabled);
+  static bool is_enabled() { return s_enabled; }
+
+  // Bracket everything the GPU does in a frame. begin_frame() also collects
+  // the results of the frame FRAME_LATENCY frames back.
+  static void begin_frame();
+  static void end_frame();
+
+  static void begin_pass(const char *name);
+  static void end_pass();
+
+  // Passes in the order they were first seen, which nests children under
+  // their parents.
+  static std::vector<PassStats> get_stats();
+  // One line per pass, indented by depth.
+  static std::string get_report();
+  // Writes get_stats() as JSON.
+  static bool write_json(const std::string &path);
+  static void reset();
+
+private:
+  struct Query {
+    uint32_t pass;
+    unsigned int begin;
+    unsigned int end;
+  };
+
+  struct FrameQueries {
+    std::vector<unsigned int> pool; // Query objects, reused every frame
+    size_t used = 0;
+    std::vector<Query> queries;
+    bool submitted = false;
+  };
+
+  struct PassHistory {
+    std::string name;
+    unsigned int depth = 0;
+    float samples[HISTORY_SIZE] = {};
+    unsigned int count = 0; // Valid samples, up to HISTORY_SIZE
+    unsigned int next = 0;  // Ring position of the next sample
+    float frame_ms = 0.0f;  // Sum for the frame being collected
+    bool seen = false;      // Whether that frame ran the pass
+  };
+
+  static uint32_t find_pass(const char *name, unsigned int depth);
+  static unsigned int next_query();
+  // Adds a finished frame's pass times to the history. Returns false (and
+  // records nothing) if any result is not available yet.
+  static bool collect(FrameQueries &frame);
+
+  static bool s_enabled;
+  static bool s_in_frame;
+  static unsigned int s_frame;
+  static FrameQueries s_frames[FRAME_LATENCY];
+  static std::vector<PassHistory> s_passes;
+  static std::vector<size_t> s_open; // Indices into the frame's queries
+  static unsigned int s_skipped_frames;
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include "graphics/Frustum.h"
+#include "graphics/StreamBuffer.h"
+#include "scene/World.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+class Mesh;
+class Scene;
+class Shader;
+
+// GPU-driven path for a scene's mesh objects. Object records, per-mesh
+// bounds and world transforms live in shader storage buffers; a compute
+// pass (shaders/cull.comp) frustum-culls every object and fills one
+// DrawElementsIndirectCommand per mesh, and the visible objects are drawn
+// with glMultiDrawElementsIndirect straight from those commands.
+//
+// Per frame the CPU copies the transform array and resets one command per
+// mesh; it never looks at individual objects unless the scene's layout
+// changed. Meshes are grouped by texture, one multi-draw per texture.
+class IndirectDrawPass {
+public:
+  IndirectDrawPass() = default;
+  ~IndirectDrawPass();
+
+  IndirectDrawPass(const IndirectDrawPass &) = delete;
+  IndirectDrawPass &operator=(const IndirectDrawPass &) = delete;
+
+  // Needs GL 4.3 (compute shaders, SSBOs, multi-draw indirect).
+  static bool is_supported();
+
+  bool init(std::shared_ptr<Shader> cull_shader);
+  // Culls the scene's mesh objects against `frustum` and draws the visible
+  // ones with `shader`, which must already be in use.
+  void draw(const Scene &scene, const Frustum &frustum, Shader &shader);
+
+  // Number of objects the GPU tests each frame.
+  size_t get_object_count() const { return m_objects.size(); }
+  // Reads back how many instances each mesh's command drew in the last
+  // draw(), in command order. Stalls on the GPU; for tests and debugging.
+  std::vector<uint32_t> read_instance_counts() const;
+
+private:
+  // Matches DrawElementsIndirectCommand and DrawCommand in cull.comp.
+  struct DrawCommand {
+    uint32_t count = 0;
+    uint32_t instance_count = 0;
+    uint32_t first_index = 0;
+    int32_t base_vertex = 0;
+    uint32_t base_instance = 0;
+  };
+
+  // A run of commands whose meshes share a texture.
+  struct DrawGroup {
+    unsigned int texture = 0;
+    uint32_t first_command = 0;
+    uint32_t command_count = 0;
+  };
+
+  static constexpr uint32_t WORKGROUP_SIZE = 64; // local_size_x in cull.comp
+
+  // Rebuilds objects, commands and groups from the scene. Only needed when
+  // the world or transform layout changed.
+  void rebuild(const Scene &scene);
+  // Replaces `buffer` with `bytes` of `data`, reallocating if it grew.
+  static void upload(unsigned int &buffer, size_t &capacity, const void *data,
+                     size_t bytes);
+
+  std::shared_ptr<Shader> m_cull_shader;
+  int m_planes_location = -1;
+  int m_object_count_location = -1;
+
+  // CPU copies, in command order
+  std::vector<DrawCommand> m_commands;
+  std::vector<DrawGroup> m_groups;
+  std::vector<glm::uvec2> m_objects; // (transform dense index, command)
+  std::vector<glm::vec4> m_mesh_spheres;
+
+  unsigned int m_command_buffer = 0;
+  unsigned int m_object_buffer = 0;
+  unsigned int m_sphere_buffer = 0;
+  unsigned int m_instance_buffer = 0;
+  size_t m_command_capacity = 0; // Bytes
+  size_t m_object_capacity = 0;
+  size_t m_sphere_capacity = 0;
+  size_t m_instance_capacity = 0;
+
+  // World matrices, copied in every frame. Streamed when persistent mapping
+  // is available, else uploaded into m_transform_buffer.
+  StreamBuffer m_transform_stream;
+  bool m_use_transform_stream = false;
+  unsigned int m_transform_buffer = 0;
+  size_t m_transform_capacity = 0;
+  size_t m_storage_alignment = 256;
+
+  // What the cached objects were built from
+  const World *m_world = nullptr;
+  const void *m_transforms = nullptr;
+  uint32_t m_world_layout_version = 0;
+  uint32_t m_transform_layout_version = 0;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "graphics/GeometryArena.h"
 #include "graphics/Shader.h"
 #include <glm/glm.hpp>
 #include <memory>
@@ -13,6 +14,15 @@ struct Vertex {
   glm::vec2 TexCoords;
 };
 
+// Object-space bounds of a mesh's vertices.
+struct MeshBounds {
+  glm::vec3 min = glm::vec3(0.0f);
+  glm::vec3 max = glm::vec3(0.0f);
+  // Bounding sphere around the box center, fitted to the vertices.
+  glm::vec3 center = glm::vec3(0.0f);
+  float radius = 0.0f;
+};
+
 class Mesh {
 public:
   // Mesh data
@@ -24,12 +34,12 @@ public:
   Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices,
        std::vector<std::shared_ptr<Texture>> textures);
 
-  // Destructor to free GPU resources
+  // Destructor to release the mesh's slice of the geometry arena
   ~Mesh();
 
-  // Disable copying to prevent double-deletion of GPU resources.
-  // A mesh's data can be shared via std::shared_ptr, but the GPU resource
-  // handle itself should have a single owner.
+  // Disable copying to prevent double-release of the geometry slice.
+  // A mesh's data can be shared via std::shared_ptr, but the slice itself
+  // should have a single owner.
   Mesh(const Mesh &) = delete;
   Mesh &operator=(const Mesh &) = delete;
 
@@ -37,15 +47,32 @@ public:
   Mesh(Mesh &&other) noexcept;
   Mesh &operator=(Mesh &&other) noexcept;
 
+  // Computed from the vertices at construction.
+  const MeshBounds &get_bounds() const { return m_bounds; }
+
+  // The VAO draws use; shared by every mesh (see GeometryArena).
+  unsigned int get_vertex_array() const;
+  // Where this mesh's vertices and indices live in the arena's buffers.
+  const GeometrySlice &get_geometry() const { return m_geometry; }
+  // The texture draws bind to unit 0, or 0 if the mesh has none.
+  unsigned int get_texture_id() const;
+
   // Render the mesh
   void draw(Shader &shader);
 
+  // Render `instance_count` copies of the mesh in a single draw call. Per
+  // instance model matrices are read from `instance_vbo` (a tightly packed
+  // array of glm::mat4), starting at `base_instance`.
+  void draw_instanced(Shader &shader, unsigned int instance_vbo,
+                      unsigned int instance_count, unsigned int base_instance);
+
 private:
-  // Render data - OpenGL handles
-  unsigned int m_vao = 0;
-  unsigned int m_vbo = 0;
-  unsigned int m_ebo = 0;
+  GeometrySlice m_geometry;
+
+  MeshBounds m_bounds;
 
-  // Initializes all the buffer objects/arrays
+  // Fills m_bounds from the vertex positions
+  void compute_bounds();
+  // Uploads the vertices and indices into the geometry arena
   void setup_mesh();
 };
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Draw submissions ordered by a 64-bit render-state key. From the most
+// significant bits down the key holds the shader, texture, mesh and depth,
+// so sorting puts draws that share the expensive state next to each other
+// and orders draws of the same state front to back.
+class RenderQueue {
+public:
+  struct Item {
+    uint64_t key = 0;
+    uint32_t payload = 0; // Caller-defined, e.g. an index into a batch array
+  };
+
+  static constexpr uint32_t SHADER_BITS = 8;
+  static constexpr uint32_t TEXTURE_BITS = 16;
+  static constexpr uint32_t MESH_BITS = 16;
+  static constexpr uint32_t DEPTH_BITS = 24;
+
+  // Builds a key from GL shader and texture names, any id that tells meshes
+  // apart, and a non-negative view depth. Ids are truncated to their field,
+  // which at worst splits a run of equal state.
+  static uint64_t make_key(uint32_t shader, uint32_t texture, uint32_t mesh,
+                           float depth);
+
+  void clear() { m_items.clear(); }
+  void push(uint64_t key, uint32_t payload) { m_items.push_back({key, payload}); }
+  // Stable LSD radix sort on the key, one byte per pass.
+  void sort();
+
+  const std::vector<Item> &items() const { return m_items; }
+  size_t size() const { return m_items.size(); }
+  bool empty() const { return m_items.empty(); }
+
+private:
+  std::vector<Item> m_items;
+  std::vector<Item> m_scratch;
+};
@@ -1,6 +1,9 @@
 #pragma once
+#include "utils/Hash.h"
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <unordered_map> // For the cache
+#include <string_view>
 #include <vector>
 
 // Include GLM headers for vector and matrix types
@@ -12,6 +15,29 @@ enum class ShaderType {
   Compute   // For a compute shader
 };
 
+// A uniform name with its hash, computed at compile time when the name is a
+// constant: `static constexpr UniformName U_TIME("u_time");` or
+// `"u_time"_uniform`.
+struct UniformName {
+  uint32_t hash;
+  std::string_view name;
+
+  constexpr explicit UniformName(std::string_view name)
+      : hash(Hash::fnv1a(name)), name(name) {}
+};
+
+constexpr UniformName operator""_uniform(const char *name, size_t length) {
+  return UniformName(std::string_view(name, length));
+}
+
+// A resolved uniform location. Resolve once with Shader::get_uniform and
+// reuse it; setting an invalid handle is a silent no-op, like GL's -1.
+struct UniformHandle {
+  int location = -1;
+
+  bool is_valid() const { return location >= 0; }
+};
+
 class Shader {
 public:
   Shader(ShaderType type, const std::vector<std::string> &paths);
@@ -28,6 +54,24 @@ public:
   // Use/activate the shader program.
   void use() const;
 
+  unsigned int get_id() const { return m_id; }
+
+  // Looks up a uniform among the ones reflected at link time. Doesn't
+  // allocate or hash. Missing uniforms give an invalid handle.
+  UniformHandle get_uniform(UniformName name) const;
+  bool has_uniform(UniformName name) const;
+
+  // Hot-path setters: no lookup at all.
+  void set_bool(UniformHandle handle, bool value);
+  void set_int(UniformHandle handle, int value);
+  void set_float(UniformHandle handle, float value);
+  void set_vec2(UniformHandle handle, const glm::vec2 &value);
+  void set_vec3(UniformHandle handle, const glm::vec3 &value);
+  void set_vec4(UniformHandle handle, const glm::vec4 &value);
+  void set_mat4(UniformHandle handle, const glm::mat4 &mat);
+
+  // By-name setters for runtime strings (scripts, console). They hash the
+  // name on every call; prefer handles in per-frame code.
   void set_bool(const std::string &name, bool value);
   void set_int(const std::string &name, int value);
   void set_float(const std::string &name, float value);
@@ -39,8 +83,20 @@ public:
 private:
   unsigned int m_id = 0; // The shader program ID
 
-  mutable std::unordered_map<std::string, int> m_uniform_location_cache;
-  int get_uniform_location(const std::string &name) const;
+  struct UniformInfo {
+    uint32_t hash;
+    int location;
+    std::string name; // Without any "[0]" array suffix
+  };
+  // Active uniforms outside blocks, sorted by hash.
+  std::vector<UniformInfo> m_uniforms;
+  // Hashes of names already reported missing, so each warns only once.
+  mutable std::vector<uint32_t> m_reported_missing;
+
+  // Fills m_uniforms from the linked program.
+  void reflect_uniforms();
+  const UniformInfo *find_uniform(uint32_t hash, std::string_view name) const;
+  UniformHandle get_uniform_checked(std::string_view name) const;
 
   // Private helper to check for compile/link errors.
   void check_compile_errors(unsigned int shader, const std::string &type);
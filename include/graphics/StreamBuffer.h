@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+
+// A GPU buffer for data rewritten every frame (instance data, particles,
+// debug lines). The buffer is allocated once with immutable storage and
+// stays persistently mapped, split into FRAMES_IN_FLIGHT regions used in
+// turn. A fence after each frame's draws tells begin_frame() when the GPU is
+// done with the region it is about to reuse, so writes never stall on an
+// implicit driver sync and nothing is reallocated per frame.
+//
+// Needs GL 4.4 (glBufferStorage); check is_supported() first.
+class StreamBuffer {
+public:
+  static constexpr unsigned int FRAMES_IN_FLIGHT = 3;
+
+  // A range of the current frame's region. `offset` is in bytes from the
+  // start of the buffer, for binding or base-instance math.
+  struct Allocation {
+    void *data = nullptr;
+    size_t offset = 0;
+    size_t size = 0;
+  };
+
+  static bool is_supported();
+
+  StreamBuffer() = default;
+  ~StreamBuffer();
+
+  StreamBuffer(const StreamBuffer &) = delete;
+  StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+  // Creates the buffer with room for `frame_capacity` bytes per frame.
+  bool init(size_t frame_capacity);
+
+  // Moves to the next region, waiting for the GPU if it still reads it.
+  void begin_frame();
+  // Makes sure a frame can hold `frame_capacity` bytes. Growing recreates
+  // the buffer (and changes get_id()), so call it after begin_frame() and
+  // before the frame's first allocate(). Returns false if the new buffer
+  // couldn't be created; the StreamBuffer is then unusable until init().
+  bool reserve(size_t frame_capacity);
+  // Returns an empty Allocation if the frame's region is full.
+  Allocation allocate(size_t size, size_t alignment = 16);
+  // Fences the frame's region. Call after the last draw that reads it.
+  void end_frame();
+
+  unsigned int get_id() const { return m_buffer; }
+  size_t get_frame_capacity() const { return m_frame_capacity; }
+
+private:
+  bool create(size_t frame_capacity);
+  void destroy();
+  // Blocks until the region's fence (if any) signals, then deletes it.
+  void wait_for_region(unsigned int region);
+
+  unsigned int m_buffer = 0;
+  unsigned char *m_mapped = nullptr;
+  size_t m_frame_capacity = 0;
+  unsigned int m_region = 0;
+  size_t m_cursor = 0; // Bytes used in the current region
+  void *m_fences[FRAMES_IN_FLIGHT] = {}; // GLsync per region
+};
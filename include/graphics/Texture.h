@@ -13,7 +13,7 @@ public:
   Texture &operator=(Texture &&other) noexcept;
 
   void bind(unsigned int slot = 0) const;
-  void unbind() const;
+  void unbind(unsigned int slot = 0) const;
 
   int get_width() const { return m_width; }
   int get_height() const { return m_height; }
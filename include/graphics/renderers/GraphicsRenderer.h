@@ -1,6 +1,14 @@
 #pragma once
+#include "graphics/Frustum.h"
+#include "graphics/IndirectDrawPass.h"
+#include "graphics/RenderQueue.h"
+#include "graphics/StreamBuffer.h"
 #include "graphics/renderers/IRenderer.h"
+#include "scene/World.h"
+#include <glm/glm.hpp>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 class Shader;
 class Scene;
@@ -21,7 +29,51 @@ public:
   void execute_command(const std::string &command_line) override;
 
 private:
+  // A run of instances in m_instance_matrices that share one mesh (and
+  // therefore one texture) and are drawn with a single instanced call.
+  struct InstanceBatch {
+    Mesh *mesh = nullptr;
+    unsigned int first_instance = 0;
+    unsigned int instance_count = 0;
+    float depth = 0.0f; // View depth of the nearest instance
+  };
+
+  // Groups the scene's renderable objects inside `frustum` by mesh and fills
+  // the instance matrix array so every batch is contiguous, then queues the
+  // batches in render-state order.
+  void build_batches(const Scene &scene, const Frustum &frustum,
+                     const glm::mat4 &view);
+  // Where this frame's instance matrices live on the GPU.
+  struct InstanceSource {
+    unsigned int buffer = 0;
+    unsigned int base_instance = 0; // Added to each batch's first_instance
+  };
+
+  // Uploads m_instance_matrices for this frame, growing storage if needed.
+  InstanceSource upload_instances();
+
   std::shared_ptr<Shader> m_shader;
   std::shared_ptr<Shader> m_canvas_shader;
   std::shared_ptr<Mesh> m_canvas_quad_mesh;
+
+  // GPU-driven path, used instead of the batches below when enabled
+  IndirectDrawPass m_indirect_pass;
+  bool m_indirect_ready = false;
+  bool m_gpu_driven = false;
+
+  // Per-frame instancing data, kept as members to reuse their allocations.
+  std::vector<InstanceBatch> m_batches;
+  std::vector<unsigned int> m_object_batch;
+  std::vector<Entity> m_visible; // Frustum query results
+  std::unordered_map<const Mesh *, unsigned int> m_batch_lookup;
+  std::vector<glm::mat4> m_instance_matrices;
+  RenderQueue m_queue; // Payloads index m_batches
+
+  // Per-frame instance matrices go through m_instance_stream when
+  // supported, else through m_instance_vbo, orphaned every frame.
+  static constexpr size_t INITIAL_INSTANCE_CAPACITY = 1024; // In matrices
+  StreamBuffer m_instance_stream;
+  bool m_use_instance_stream = false;
+  unsigned int m_instance_vbo = 0;
+  size_t m_instance_capacity = 0; // In matrices
 };
@@ -0,0 +1,116 @@
+#pragma once
+#include "scene/TransformStore.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Evaluates property animations in bulk. Each kind of animation keeps its
+// parameters in its own structure-of-arrays track list, so a frame is three
+// straight loops of float math (vectorizable, with a polynomial sine instead
+// of libm calls) followed by writes into the TransformStore.
+//
+// Large track lists are split across the JobSystem in chunks of
+// TRACK_CHUNK_SIZE. A chunk only writes its own tracks' targets, so a kind
+// runs in parallel only while each of its tracks targets a different
+// transform; tracks sharing a target compose in order and run serially.
+class AnimationSystem {
+public:
+  enum class Kind : uint8_t { Rotation, Position, Scale };
+
+  // Tracks per job.
+  static constexpr size_t TRACK_CHUNK_SIZE = 1024;
+
+  // Stable identifier of a registered track.
+  struct TrackId {
+    Kind kind = Kind::Rotation;
+    uint32_t id = TransformHandle::INVALID_INDEX;
+
+    bool is_valid() const { return id != TransformHandle::INVALID_INDEX; }
+  };
+
+  // Spins the target around `axis` at a constant rate.
+  TrackId add_rotation(TransformHandle target, const glm::vec3 &axis,
+                       float degrees_per_second);
+  // Moves the target along `direction` around `origin`:
+  // origin + direction * sin(t * speed) * distance.
+  TrackId add_position(TransformHandle target, const glm::vec3 &origin,
+                       const glm::vec3 &direction, float speed,
+                       float distance);
+  // Pulses the target's scale between base_scale * min and base_scale * max.
+  TrackId add_scale(TransformHandle target, const glm::vec3 &base_scale,
+                    float speed, float min_scale, float max_scale);
+  void remove(TrackId track);
+
+  size_t size() const;
+
+  // Advances every track and writes the results into `transforms`, which
+  // must be the store the target handles belong to.
+  void update(TransformStore &transforms, float delta_time, double total_time);
+
+private:
+  // Maps stable track ids to dense indices, mirroring TransformStore's slots.
+  struct TrackIndex {
+    std::vector<uint32_t> dense_to_id;
+    std::vector<uint32_t> id_to_dense;
+    std::vector<uint32_t> free_ids;
+
+    uint32_t add();
+    // Frees `id` and returns the dense index the caller must swap-remove.
+    uint32_t remove(uint32_t id);
+  };
+
+  // Target bookkeeping shared by every kind. Dense target indices are cached
+  // and refreshed when the TransformStore layout changes.
+  struct Targets {
+    std::vector<TransformHandle> handles;
+    std::vector<uint32_t> dense;
+    // No two live tracks share a target, so chunks can run concurrently.
+    bool unique = true;
+  };
+
+  struct RotationTracks {
+    TrackIndex index;
+    Targets targets;
+    std::vector<float> axis_x, axis_y, axis_z;
+    std::vector<float> turns_per_second; // Half-angle, in full turns
+  };
+
+  struct PositionTracks {
+    TrackIndex index;
+    Targets targets;
+    std::vector<float> origin_x, origin_y, origin_z;
+    std::vector<float> direction_x, direction_y, direction_z;
+    std::vector<float> turns_per_second;
+    std::vector<float> distance;
+  };
+
+  struct ScaleTracks {
+    TrackIndex index;
+    Targets targets;
+    std::vector<float> base_x, base_y, base_z;
+    std::vector<float> turns_per_second;
+    std::vector<float> min_scale;
+    std::vector<float> half_range;
+  };
+
+  void refresh_targets(const TransformStore &transforms);
+  // Calls body(begin, end) over the tracks of one kind, in parallel chunks
+  // when its targets are unique.
+  template <typename Func>
+  static void run_tracks(const Targets &targets, Func &&body);
+  void update_rotations(TransformStore &transforms, float delta_time);
+  void update_positions(TransformStore &transforms, double total_time);
+  void update_scales(TransformStore &transforms, double total_time);
+
+  RotationTracks m_rotations;
+  PositionTracks m_positions;
+  ScaleTracks m_scales;
+
+  // Scratch arrays for the batched sine evaluation.
+  std::vector<float> m_phase;
+  std::vector<float> m_sin;
+  std::vector<float> m_cos;
+
+  const TransformStore *m_cached_store = nullptr;
+  uint32_t m_cached_layout_version = 0;
+};
@@ -0,0 +1,81 @@
+#pragma once
+#include "graphics/Frustum.h"
+#include "scene/World.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Dynamic bounding volume hierarchy over every World entity that has
+// WorldBounds. The tree is built top-down with a binned surface area
+// heuristic (SAH). Each update refits the existing tree to the entities' new
+// bounds, and only rebuilds when entities were added or removed or refitting
+// has let the tree degrade past REBUILD_THRESHOLD.
+//
+// Leaves hold at most MAX_LEAF_SIZE primitives, stored contiguously so a
+// leaf's spheres can be culled in one SIMD batch.
+class Bvh {
+public:
+  struct RayHit {
+    Entity entity;
+    float distance = 0.0f;
+  };
+
+  // Brings the tree in line with the world's current WorldBounds.
+  void update(const World &world);
+
+  // The queries append matching entities to `out`. Results reflect the last
+  // update().
+  void query_frustum(const Frustum &frustum, std::vector<Entity> &out) const;
+  void query_sphere(const glm::vec3 &center, float radius,
+                    std::vector<Entity> &out) const;
+  void query_box(const Aabb &box, std::vector<Entity> &out) const;
+  // Finds the closest entity whose bounding sphere the ray enters within
+  // `max_distance`. `direction` must be normalized.
+  bool raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+               float max_distance, RayHit &hit) const;
+
+  size_t size() const { return m_entities.size(); }
+  size_t get_node_count() const { return m_nodes.size(); }
+
+private:
+  static constexpr uint32_t MAX_LEAF_SIZE = 4;
+  static constexpr uint32_t BIN_COUNT = 8;
+  // Rebuild once refitting has grown the summed node area by this factor.
+  static constexpr float REBUILD_THRESHOLD = 1.5f;
+
+  struct Node {
+    Aabb bounds;
+    uint32_t left = 0; // Left child (right is left + 1); 0 for leaves
+    // Every node covers a contiguous range of primitives.
+    uint32_t first_prim = 0;
+    uint32_t prim_count = 0;
+
+    bool is_leaf() const { return left == 0; }
+  };
+
+  // Rebuilds the tree over the current primitive arrays and reorders them
+  // into leaf order.
+  void rebuild();
+  // Splits a node along the best SAH plane. Returns false if it stays a leaf.
+  bool split(uint32_t node_index);
+  // Recomputes every node's bounds bottom-up. Returns the summed node area.
+  float refit();
+
+  // Primitives, in leaf order after a build.
+  std::vector<Entity> m_entities;
+  std::vector<BoundingSphere> m_spheres;
+  std::vector<Aabb> m_boxes;
+  // Position in the World's WorldBounds query -> primitive index.
+  std::vector<uint32_t> m_source_to_prim;
+
+  // Parents always precede their children.
+  std::vector<Node> m_nodes;
+  float m_built_area = 0.0f;
+
+  const World *m_world = nullptr;
+  uint32_t m_world_layout_version = 0;
+
+  // Build scratch
+  std::vector<uint32_t> m_order;
+  std::vector<glm::vec3> m_centroids;
+};
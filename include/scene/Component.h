@@ -3,15 +3,28 @@
 #include <memory>
 
 class SceneObject; // Forward-declaration
+class Scene;
 
 class Component {
 public:
   virtual ~Component() = default;
   // Called when the component is attached to an object
   virtual void awake() {}
+  // Called once the owning object is in a scene: from Scene::add_object, or
+  // right after awake() if the object was already added.
+  virtual void on_added_to_scene(Scene &scene) {}
   // Called every frame
   virtual void update(float delta_time) {}
 
+  // Component types that redefine this as true have update() called from job
+  // system worker threads, concurrently with other components of the same
+  // type. Such an update may only touch the component's own state and its
+  // owner's transform values (position, rotation, scale). It must not
+  // reparent, add or remove components or objects, read other objects, or
+  // call into OpenGL, Lua, the ResourceManager or the EventDispatcher. Other
+  // types are updated on the main thread.
+  static constexpr bool PARALLEL_SAFE = false;
+
 protected:
   std::weak_ptr<SceneObject> m_owner;
   friend class SceneObject;
@@ -0,0 +1,262 @@
+#pragma once
+#include "scene/Component.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class Scene;
+
+// Type-erased interface the ComponentStore uses to drive every pool.
+class ComponentPoolBase {
+public:
+  virtual ~ComponentPoolBase() = default;
+
+  virtual void destroy(uint32_t slot) = 0;
+  // Records which scene the component in `slot` belongs to (nullptr: none).
+  virtual void set_scene(uint32_t slot, const Scene *scene) = 0;
+
+  // Number of live components belonging to `scene`.
+  virtual uint32_t live_count(const Scene *scene) const = 0;
+  // False if the component type doesn't override Component::update().
+  virtual bool has_update() const = 0;
+  virtual bool is_parallel_safe() const = 0;
+  // Updates the components [begin, end) of `scene`'s live list.
+  virtual void update_range(const Scene *scene, uint32_t begin, uint32_t end,
+                            float delta_time) = 0;
+  // Bracket an update pass. In between, destroy() leaves the lists and free
+  // slots alone, so no live component shifts into an already-visited index.
+  virtual void begin_updates() = 0;
+  virtual void end_updates() = 0;
+};
+
+// Holds every component of type T in fixed-size blocks of contiguous memory.
+// Removal leaves a hole that the next add reuses, so component addresses
+// never change. Each scene keeps a dense list of its live slots, so updates
+// touch only that scene's components, with a non-virtual call per component.
+template <typename T> class ComponentPool : public ComponentPoolBase {
+public:
+  static constexpr uint32_t BLOCK_SIZE = 64;
+
+  ComponentPool() = default;
+  ComponentPool(const ComponentPool &) = delete;
+  ComponentPool &operator=(const ComponentPool &) = delete;
+
+  ~ComponentPool() override {
+    for (uint32_t slot = 0; slot < m_slot_count; ++slot) {
+      destroy(slot);
+    }
+  }
+
+  // Constructs a component in a free slot. Returns it and its slot.
+  template <typename... Args>
+  std::pair<T *, uint32_t> create(const Scene *scene, Args &&...args) {
+    uint32_t slot;
+    if (!m_free_slots.empty()) {
+      slot = m_free_slots.back();
+      m_free_slots.pop_back();
+    } else {
+      slot = m_slot_count++;
+      if (slot / BLOCK_SIZE == m_blocks.size()) {
+        m_blocks.push_back(std::make_unique<Block>());
+      }
+    }
+
+    Block &block = *m_blocks[slot / BLOCK_SIZE];
+    const uint32_t i = slot % BLOCK_SIZE;
+    T *component = new (block.address(i)) T(std::forward<Args>(args)...);
+    block.alive[i] = true;
+    block.scenes[i] = scene;
+    link(slot);
+    return {component, slot};
+  }
+
+  void destroy(uint32_t slot) override {
+    Block &block = *m_blocks[slot / BLOCK_SIZE];
+    const uint32_t i = slot % BLOCK_SIZE;
+    if (!block.alive[i]) {
+      return;
+    }
+    block.get(i)->~T();
+    block.alive[i] = false;
+    if (m_updating) {
+      // Still listed until end_updates(); update_range() skips it.
+      m_deferred_frees.push_back(slot);
+      return;
+    }
+    release(slot);
+  }
+
+  void set_scene(uint32_t slot, const Scene *scene) override {
+    unlink(slot);
+    m_blocks[slot / BLOCK_SIZE]->scenes[slot % BLOCK_SIZE] = scene;
+    link(slot);
+  }
+
+  uint32_t live_count(const Scene *scene) const override {
+    const uint32_t list = find_list(scene);
+    return list == NO_LIST
+               ? 0
+               : static_cast<uint32_t>(m_scene_slots[list].slots.size());
+  }
+  bool has_update() const override { return HAS_UPDATE; }
+  bool is_parallel_safe() const override { return T::PARALLEL_SAFE; }
+
+  void begin_updates() override { m_updating = true; }
+  void end_updates() override {
+    m_updating = false;
+    for (uint32_t slot : m_deferred_frees) {
+      release(slot);
+    }
+    m_deferred_frees.clear();
+  }
+
+  void update_range(const Scene *scene, uint32_t begin, uint32_t end,
+                    float delta_time) override {
+    if constexpr (HAS_UPDATE) {
+      const uint32_t list = find_list(scene);
+      if (list == NO_LIST) {
+        return;
+      }
+      for (uint32_t n = begin; n < end; ++n) {
+        // Re-read each step: a main-thread update may add components and so
+        // reallocate the list.
+        const std::vector<uint32_t> &slots = m_scene_slots[list].slots;
+        if (n >= slots.size()) {
+          break;
+        }
+        const uint32_t slot = slots[n];
+        Block &block = *m_blocks[slot / BLOCK_SIZE];
+        if (block.alive[slot % BLOCK_SIZE]) {
+          block.get(slot % BLOCK_SIZE)->T::update(delta_time);
+        }
+      }
+    }
+  }
+
+private:
+  // &T::update only has Component's signature if T didn't override it.
+  static constexpr bool HAS_UPDATE =
+      !std::is_same_v<decltype(&T::update), void (Component::*)(float)>;
+
+  struct Block {
+    alignas(T) unsigned char storage[BLOCK_SIZE * sizeof(T)];
+    const Scene *scenes[BLOCK_SIZE] = {};
+    uint32_t list_index[BLOCK_SIZE] = {}; // Position in its scene's list
+    bool alive[BLOCK_SIZE] = {};
+
+    void *address(uint32_t i) { return storage + i * sizeof(T); }
+    T *get(uint32_t i) { return std::launder(static_cast<T *>(address(i))); }
+  };
+
+  // The live slots of one scene, in no particular order.
+  struct SceneSlots {
+    const Scene *scene;
+    std::vector<uint32_t> slots;
+  };
+
+  static constexpr uint32_t NO_LIST = ~0u;
+
+  // There are only ever a handful of scenes, so a linear search wins. Lists
+  // are never dropped, so an index stays valid while components come and go.
+  uint32_t find_list(const Scene *scene) const {
+    for (uint32_t n = 0; n < m_scene_slots.size(); ++n) {
+      if (m_scene_slots[n].scene == scene) {
+        return n;
+      }
+    }
+    return NO_LIST;
+  }
+
+  // Appends `slot` to its scene's list. Slots without a scene aren't listed.
+  void link(uint32_t slot) {
+    Block &block = *m_blocks[slot / BLOCK_SIZE];
+    const uint32_t i = slot % BLOCK_SIZE;
+    if (!block.scenes[i]) {
+      return;
+    }
+    uint32_t list = find_list(block.scenes[i]);
+    if (list == NO_LIST) {
+      list = static_cast<uint32_t>(m_scene_slots.size());
+      m_scene_slots.push_back(SceneSlots{block.scenes[i], {}});
+    }
+    std::vector<uint32_t> &slots = m_scene_slots[list].slots;
+    block.list_index[i] = static_cast<uint32_t>(slots.size());
+    slots.push_back(slot);
+  }
+
+  // Swap-removes `slot` from its scene's list.
+  void unlink(uint32_t slot) {
+    Block &block = *m_blocks[slot / BLOCK_SIZE];
+    const uint32_t i = slot % BLOCK_SIZE;
+    if (!block.scenes[i]) {
+      return;
+    }
+    std::vector<uint32_t> &slots =
+        m_scene_slots[find_list(block.scenes[i])].slots;
+    const uint32_t index = block.list_index[i];
+    const uint32_t moved = slots.back();
+    slots[index] = moved;
+    m_blocks[moved / BLOCK_SIZE]->list_index[moved % BLOCK_SIZE] = index;
+    slots.pop_back();
+  }
+
+  // Unlists a destroyed slot and makes it available for reuse.
+  void release(uint32_t slot) {
+    unlink(slot);
+    m_blocks[slot / BLOCK_SIZE]->scenes[slot % BLOCK_SIZE] = nullptr;
+    m_free_slots.push_back(slot);
+  }
+
+  std::vector<std::unique_ptr<Block>> m_blocks;
+  std::vector<SceneSlots> m_scene_slots;
+  std::vector<uint32_t> m_free_slots;
+  // Destroyed during the current update pass, released by end_updates().
+  std::vector<uint32_t> m_deferred_frees;
+  uint32_t m_slot_count = 0;
+  bool m_updating = false;
+};
+
+// Owns one ComponentPool per component type. There is a single store for
+// the whole process; SceneObjects and Scenes share ownership of it, so it
+// outlives every component regardless of destruction order (Lua can hold
+// objects past the scene).
+class ComponentStore {
+public:
+  static std::shared_ptr<ComponentStore> instance();
+
+  ComponentStore() = default;
+  ComponentStore(const ComponentStore &) = delete;
+  ComponentStore &operator=(const ComponentStore &) = delete;
+
+  // Small dense id per component type, assigned on first use.
+  template <typename T> static uint32_t type_id() {
+    static const uint32_t s_id = s_next_type_id++;
+    return s_id;
+  }
+
+  template <typename T> ComponentPool<T> &pool() {
+    static_assert(std::is_base_of_v<Component, T>,
+                  "Components must derive from Component");
+    const uint32_t id = type_id<T>();
+    if (id >= m_pools.size()) {
+      m_pools.resize(id + 1);
+    }
+    if (!m_pools[id]) {
+      m_pools[id] = std::make_unique<ComponentPool<T>>();
+    }
+    return static_cast<ComponentPool<T> &>(*m_pools[id]);
+  }
+
+  // Updates every component of `scene`, one linear pass per component type.
+  // Types marked PARALLEL_SAFE are split across the job system.
+  void update(const Scene &scene, float delta_time);
+
+private:
+  std::vector<std::unique_ptr<ComponentPoolBase>> m_pools;
+
+  static std::atomic<uint32_t> s_next_type_id;
+};
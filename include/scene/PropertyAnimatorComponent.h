@@ -1,8 +1,13 @@
 #pragma once
+#include "scene/AnimationSystem.h"
 #include "scene/Component.h"
 #include <glm/glm.hpp>
+#include <memory>
 #include <variant>
 
+// Describes a property animation. The animation itself is evaluated in bulk
+// by the scene's AnimationSystem; this component registers a track there when
+// its object enters a scene and removes it when destroyed or re-added.
 class PropertyAnimatorComponent : public Component {
 public:
   // This enum is now the primary way to specify the animation type
@@ -30,14 +35,17 @@ public:
 
   // A single, explicit public constructor
   PropertyAnimatorComponent(TargetProperty target, AnimationParams params);
+  ~PropertyAnimatorComponent() override;
 
-  void update(float delta_time) override;
-  void awake() override;
+  void on_added_to_scene(Scene &scene) override;
 
 private:
+  // Removes the registered track, if any, from its AnimationSystem.
+  void release_track();
+
   TargetProperty m_target;
   AnimationParams m_params;
 
-  glm::vec3 m_original_position;
-  glm::vec3 m_original_scale;
+  std::weak_ptr<AnimationSystem> m_system;
+  AnimationSystem::TrackId m_track;
 };
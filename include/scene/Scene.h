@@ -1,18 +1,29 @@
 #pragma once
 
+#include "scene/AnimationSystem.h"
+#include "scene/Bvh.h"
 #include "scene/SceneObject.h"
+#include "scene/TransformStore.h"
+#include "scene/World.h"
 #include <memory>
+#include <tuple>
 #include <vector>
 
 class Scene {
 public:
   // Constructor: Initializes the scene, including the default camera.
   Scene();
+  ~Scene();
 
-  // Adds a new object to the scene.
+  // Adds a new object to the scene. Its transform moves into the scene's
+  // TransformStore and its entity into the scene's World.
   void add_object(std::shared_ptr<SceneObject> object);
 
   void update(float delta_time);
+  // Fixed-step rendering, once the frame's steps have run: blends the world
+  // matrices with the previous step's by `alpha` and refits the bounds and
+  // spatial index to the blended matrices, so culling matches what is drawn.
+  void interpolate(float alpha);
 
   // Provides const access to the list of objects for rendering.
   const std::vector<std::shared_ptr<SceneObject>> &get_scene_objects() const;
@@ -20,7 +31,52 @@ public:
   void set_active_camera(std::shared_ptr<SceneObject> camera_object);
   std::shared_ptr<SceneObject> get_active_camera() const;
 
+  TransformStore &get_transform_store() { return *m_transforms; }
+  const TransformStore &get_transform_store() const { return *m_transforms; }
+
+  // Entity data of every object in the scene, for archetype queries.
+  World &get_world() { return *m_world; }
+  const World &get_world() const { return *m_world; }
+
+  // Spatial index over the world bounds of every mesh object, refreshed at
+  // the end of update(), or only by interpolate() with fixed update.
+  const Bvh &get_spatial_index() const { return m_spatial_index; }
+
+  // Objects whose bounds touch a sphere or a box, as of the spatial index's
+  // last refit.
+  std::vector<std::shared_ptr<SceneObject>>
+  query_sphere(const glm::vec3 &center, float radius) const;
+  std::vector<std::shared_ptr<SceneObject>>
+  query_box(const glm::vec3 &min, const glm::vec3 &max) const;
+  // The closest object whose bounds the ray hits, and the distance to it, or
+  // nullptr. `direction` need not be normalized.
+  std::tuple<std::shared_ptr<SceneObject>, float>
+  raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+          float max_distance) const;
+
+  // Batched evaluator for PropertyAnimatorComponents of this scene's objects.
+  std::shared_ptr<AnimationSystem> get_animation_system() {
+    return m_animations;
+  }
+
 private:
+  // Transforms every mesh's bounding sphere by its object's render matrix.
+  void update_bounds();
+  // update_bounds(), then refits the spatial index to the new bounds.
+  void refit_bounds();
+  std::vector<std::shared_ptr<SceneObject>>
+  to_objects(const std::vector<Entity> &entities) const;
+
   std::vector<std::shared_ptr<SceneObject>> m_scene_objects;
+  // Shared so transforms and entities of objects still referenced elsewhere
+  // (e.g. by Lua) stay valid if the scene is destroyed first.
+  std::shared_ptr<TransformStore> m_transforms;
+  std::shared_ptr<World> m_world;
+  // Components keep a weak_ptr to unregister their tracks.
+  std::shared_ptr<AnimationSystem> m_animations;
+  std::shared_ptr<ComponentStore> m_component_store;
   std::weak_ptr<SceneObject> m_active_camera;
+  Bvh m_spatial_index;
+  // Scratch for the query helpers.
+  mutable std::vector<Entity> m_query_results;
 };
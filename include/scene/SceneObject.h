@@ -1,40 +1,144 @@
 #pragma once
 
+#include "graphics/Frustum.h"
 #include "graphics/Mesh.h"
 #include "scene/Component.h"
+#include "scene/ComponentStore.h"
 #include "scene/TransformComponent.h"
+#include "scene/World.h"
 #include <memory>
-#include <typeindex>
-#include <unordered_map>
+#include <type_traits>
+#include <vector>
 
-struct SceneObject : std::enable_shared_from_this<SceneObject> {
-  // Use a shared_ptr so multiple objects can share the same mesh data (e.g., a
-  // forest of identical trees)
+class Scene;
+struct SceneObject;
+
+// World data every SceneObject entity carries: the slot of its transform in
+// the scene's TransformStore.
+struct TransformLink {
+  TransformHandle handle;
+};
+
+// World data of objects that have a mesh. Rendering queries entities with
+// TransformLink + MeshRef.
+struct MeshRef {
   std::shared_ptr<Mesh> mesh;
-  std::shared_ptr<TransformComponent> transform;
+};
 
-  std::unordered_map<std::type_index, std::shared_ptr<Component>> m_components;
+// Back-pointer from an entity to the SceneObject that owns it, so World and
+// spatial queries can hand objects back to scripts.
+struct ObjectRef {
+  SceneObject *object = nullptr;
+};
+
+// World-space bounding sphere of a mesh object, refreshed by Scene::update
+// after the world matrices. Always present alongside MeshRef.
+struct WorldBounds {
+  BoundingSphere sphere = BoundingSphere(0.0f);
+};
+
+// A handle-style facade over one World entity plus its behaviour components.
+// Plain data types passed to add_component/get_component are stored in the
+// World's archetype chunks; types derived from Component live in
+// ComponentPools so they keep stable addresses and can repeat.
+struct SceneObject : std::enable_shared_from_this<SceneObject> {
+  // Lives in the detached TransformStore until the object is added to a
+  // scene, then in that scene's store.
+  TransformComponent transform;
 
   SceneObject(std::shared_ptr<Mesh> m);
   SceneObject();
+  ~SceneObject();
 
-  void update(float delta_time);
+  SceneObject(const SceneObject &) = delete;
+  SceneObject &operator=(const SceneObject &) = delete;
 
-  template <typename T, typename... Args>
-  std::shared_ptr<T> add_component(Args &&...args) {
-    auto new_comp = std::make_shared<T>(std::forward<Args>(args)...);
-    new_comp->m_owner = shared_from_this();
-    new_comp->awake();
-    m_components[std::type_index(typeid(T))] = new_comp;
-    return new_comp;
+  // Use a shared_ptr so multiple objects can share the same mesh data (e.g., a
+  // forest of identical trees)
+  std::shared_ptr<Mesh> get_mesh() const;
+  void set_mesh(std::shared_ptr<Mesh> mesh);
+
+  Entity get_entity() const { return m_entity; }
+  World &get_world() const { return *m_world; }
+
+  // Attaches this object's transform to `parent`'s (nullptr detaches). Both
+  // objects must already be in the same scene.
+  bool set_parent(const std::shared_ptr<SceneObject> &parent);
+
+  // Adds a component. Component pointers stay valid until this object is
+  // destroyed; pointers to World data only until the object's next
+  // add_component of a data type.
+  template <typename T, typename... Args> T *add_component(Args &&...args) {
+    if constexpr (std::is_base_of_v<Component, T>) {
+      ComponentPool<T> &pool = m_component_store->pool<T>();
+      auto [new_comp, slot] =
+          pool.create(m_scene, std::forward<Args>(args)...);
+      m_components.push_back(
+          ComponentEntry{ComponentStore::type_id<T>(), slot, new_comp, &pool});
+      new_comp->m_owner = shared_from_this();
+      new_comp->awake();
+      if (m_scene) {
+        new_comp->on_added_to_scene(*m_scene);
+      }
+      return new_comp;
+    } else {
+      return &m_world->add<T>(m_entity, std::forward<Args>(args)...);
+    }
   }
 
   // Finds and returns the first component of the specified type.
-  template <typename T> std::shared_ptr<T> get_component() {
-    auto it = m_components.find(std::type_index(typeid(T)));
-    if (it != m_components.end()) {
-      return std::static_pointer_cast<T>(it->second);
+  template <typename T> T *get_component() const {
+    if constexpr (std::is_base_of_v<Component, T>) {
+      const uint32_t type = ComponentStore::type_id<T>();
+      for (const auto &entry : m_components) {
+        if (entry.type == type) {
+          return static_cast<T *>(entry.component);
+        }
+      }
+      return nullptr;
+    } else {
+      return m_world->get<T>(m_entity);
+    }
+  }
+
+  // Returns every Component of the specified type, in the order added.
+  template <typename T> std::vector<T *> get_components() const {
+    static_assert(std::is_base_of_v<Component, T>,
+                  "Only Component types can repeat on an object");
+    std::vector<T *> result;
+    const uint32_t type = ComponentStore::type_id<T>();
+    for (const auto &entry : m_components) {
+      if (entry.type == type) {
+        result.push_back(static_cast<T *>(entry.component));
+      }
     }
-    return nullptr;
+    return result;
   }
+
+private:
+  friend class Scene;
+
+  // A component owned by this object, living in its type's ComponentPool.
+  struct ComponentEntry {
+    uint32_t type; // ComponentStore::type_id
+    uint32_t slot;
+    Component *component;
+    ComponentPoolBase *pool;
+  };
+
+  // Moves the transform and the entity into a scene's store and world.
+  void move_to(std::shared_ptr<TransformStore> transforms,
+               std::shared_ptr<World> world);
+
+  // In the order they were added. An object may hold several components of
+  // the same type.
+  std::vector<ComponentEntry> m_components;
+  // The scene this object was added to, if any. Set by Scene::add_object.
+  Scene *m_scene = nullptr;
+
+  // Keeps the pools alive for as long as this object's components are.
+  std::shared_ptr<ComponentStore> m_component_store;
+
+  std::shared_ptr<World> m_world;
+  Entity m_entity;
 };
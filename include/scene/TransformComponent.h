@@ -1,18 +1,59 @@
 #pragma once
-#include "scene/Component.h"
+#include "scene/TransformStore.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include <memory>
 
-class TransformComponent : public Component {
+// A view onto one slot of a TransformStore. The data itself lives in the
+// store's dense arrays; this object only owns the slot and resolves the
+// handle on access.
+class TransformComponent {
 public:
-  glm::vec3 position;
-  glm::quat rotation;
-  glm::vec3 scale;
-
-  TransformComponent(const glm::vec3 &pos = glm::vec3(0.0f),
+  // Allocates a slot in `store`.
+  TransformComponent(std::shared_ptr<TransformStore> store,
+                     const glm::vec3 &pos = glm::vec3(0.0f),
                      const glm::quat &rot = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
                      const glm::vec3 &scl = glm::vec3(1.0f));
+  // Releases the slot.
+  ~TransformComponent();
+
+  // The slot is uniquely owned.
+  TransformComponent(const TransformComponent &) = delete;
+  TransformComponent &operator=(const TransformComponent &) = delete;
+
+  const glm::vec3 &get_position() const;
+  const glm::quat &get_rotation() const;
+  const glm::vec3 &get_scale() const;
+  void set_position(const glm::vec3 &position);
+  void set_rotation(const glm::quat &rotation);
+  void set_scale(const glm::vec3 &scale);
+
+  // Returns the cached model matrix. The store's update_world_matrices()
+  // must have run since the transform (or an ancestor) last changed.
+  const glm::mat4 &get_transform_matrix() const;
+  // The matrix computed by the store's last update_world_matrices() pass.
+  const glm::mat4 &get_world_matrix() const;
+  // The matrix this frame draws with (see TransformStore::render_matrices).
+  const glm::mat4 &get_render_matrix() const;
+
+  // Makes this transform relative to `parent` (nullptr detaches it). Both
+  // transforms must live in the same store. Returns false on a store mismatch
+  // or if the parenting would form a cycle.
+  bool set_parent(const TransformComponent *parent);
+
+  // Moves this transform's data into `store`, keeping its current values.
+  // Parent and child links do not carry over.
+  void move_to(std::shared_ptr<TransformStore> store);
+
+  TransformStore &get_store() const { return *m_store; }
+  const std::shared_ptr<TransformStore> &get_shared_store() const {
+    return m_store;
+  }
+  TransformHandle get_handle() const { return m_handle; }
+
+private:
+  uint32_t dense_index() const { return m_store->dense_index(m_handle); }
 
-  // Calculates and returns the model matrix
-  glm::mat4 get_transform_matrix() const;
+  std::shared_ptr<TransformStore> m_store;
+  TransformHandle m_handle;
 };
@@ -0,0 +1,159 @@
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <memory>
+#include <vector>
+
+// A stable reference to a transform slot. Handles stay valid while other
+// transforms are created and destroyed; the generation detects stale handles.
+struct TransformHandle {
+  static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+  uint32_t index = INVALID_INDEX; // Slot in the sparse table
+  uint32_t generation = 0;
+
+  bool is_valid() const { return index != INVALID_INDEX; }
+};
+
+// Owns transform data in structure-of-arrays form. Positions, rotations,
+// scales and world matrices each live in their own dense array so systems
+// can iterate one property over every transform without chasing pointers.
+// Removal swaps the last element into the hole, so dense indices are not
+// stable; always go through a TransformHandle.
+//
+// Transforms can be parented to other transforms in the same store. Position,
+// rotation and scale are then relative to the parent, and the world matrix is
+// parent_world * local.
+//
+// Local and world matrices are cached. Writing a position, rotation or scale
+// must be followed by mark_dirty() so the next update recomputes that matrix
+// and every matrix below it; unchanged subtrees cost one flag check each.
+class TransformStore {
+public:
+  TransformStore() = default;
+
+  TransformStore(const TransformStore &) = delete;
+  TransformStore &operator=(const TransformStore &) = delete;
+
+  // Shared store that holds transforms of objects not yet added to a scene.
+  static std::shared_ptr<TransformStore> detached();
+
+  TransformHandle create(const glm::vec3 &pos = glm::vec3(0.0f),
+                         const glm::quat &rot = glm::quat(1.0f, 0.0f, 0.0f,
+                                                          0.0f),
+                         const glm::vec3 &scl = glm::vec3(1.0f));
+  // Destroys a transform. Its children become roots, keeping their local
+  // values.
+  void destroy(TransformHandle handle);
+  bool is_alive(TransformHandle handle) const;
+
+  // Parents `child` to `parent`, or makes it a root if `parent` is invalid.
+  // Returns false (and changes nothing) if that would create a cycle.
+  bool set_parent(TransformHandle child, TransformHandle parent);
+  TransformHandle get_parent(TransformHandle handle) const;
+
+  // Position of a live handle in the dense arrays.
+  uint32_t dense_index(TransformHandle handle) const {
+    return m_slot_to_dense[handle.index];
+  }
+
+  // Number of live transforms (the length of every dense array).
+  size_t size() const { return m_positions.size(); }
+
+  // Changes whenever existing dense indices move (i.e. on destroy), so
+  // systems can cache dense indices and refresh them only when needed.
+  uint32_t get_layout_version() const { return m_layout_version; }
+
+  // Dense arrays, indexed by dense_index(). Call mark_dirty() after writing
+  // through the mutable accessors.
+  std::vector<glm::vec3> &positions() { return m_positions; }
+  std::vector<glm::quat> &rotations() { return m_rotations; }
+  std::vector<glm::vec3> &scales() { return m_scales; }
+  const std::vector<glm::vec3> &positions() const { return m_positions; }
+  const std::vector<glm::quat> &rotations() const { return m_rotations; }
+  const std::vector<glm::vec3> &scales() const { return m_scales; }
+  const std::vector<glm::mat4> &local_matrices() const {
+    return m_local_matrices;
+  }
+  const std::vector<glm::mat4> &world_matrices() const {
+    return m_world_matrices;
+  }
+
+  void mark_dirty(uint32_t dense) { m_dirty[dense] = 1; }
+  bool is_dirty(uint32_t dense) const { return m_dirty[dense] != 0; }
+
+  // Returns the world matrix of a transform as of the last
+  // update_world_matrices(). A pure read, so concurrent readers are safe;
+  // the transform and its ancestors must not have changed since that update.
+  const glm::mat4 &world_matrix(uint32_t dense) const;
+  // Whether the transform or an ancestor changed since the last update.
+  bool is_stale(uint32_t dense) const;
+
+  // Rebuilds the local matrix of every dirty transform and the world matrix
+  // of every transform in a dirty subtree, parents before children.
+  void update_world_matrices();
+
+  // Fixed-step interpolation: keep the world matrices from before a
+  // simulation step, then blend them with the current ones by the
+  // interpolation alpha once the frame's steps have run.
+  void store_previous_world_matrices();
+  void interpolate_world_matrices(float alpha);
+  // The matrices to render with: the blended ones if
+  // interpolate_world_matrices() ran since the last update, otherwise the
+  // world matrices.
+  const std::vector<glm::mat4> &render_matrices() const {
+    return m_interpolated ? m_render_matrices : m_world_matrices;
+  }
+  const glm::mat4 &render_matrix(uint32_t dense) const {
+    return render_matrices()[dense];
+  }
+
+  // Builds a Translation * Rotation * Scale matrix.
+  static glm::mat4 compose_matrix(const glm::vec3 &position,
+                                  const glm::quat &rotation,
+                                  const glm::vec3 &scale);
+
+private:
+  // Rebuilds m_order and m_parent_dense after the hierarchy or the dense
+  // layout changed.
+  void rebuild_order();
+  // Removes `child_slot` from its parent's child list.
+  void unlink_from_parent(uint32_t child_slot);
+
+  // Dense SoA data
+  std::vector<glm::vec3> m_positions;
+  std::vector<glm::quat> m_rotations;
+  std::vector<glm::vec3> m_scales;
+  std::vector<glm::mat4> m_local_matrices;
+  std::vector<glm::mat4> m_world_matrices;
+  std::vector<uint8_t> m_dirty;
+  std::vector<uint32_t> m_dense_to_slot;
+
+  // Sparse slot table
+  std::vector<uint32_t> m_slot_to_dense;
+  std::vector<uint32_t> m_generations;
+  std::vector<uint32_t> m_free_slots;
+
+  // Hierarchy links, indexed by slot so they survive dense reordering.
+  std::vector<uint32_t> m_parent;
+  std::vector<uint32_t> m_first_child;
+  std::vector<uint32_t> m_next_sibling;
+
+  // Dense indices in breadth-first order (every parent precedes its
+  // children) and each dense entry's parent dense index. Rebuilt lazily.
+  std::vector<uint32_t> m_order;
+  std::vector<uint32_t> m_parent_dense;
+  bool m_order_dirty = false;
+  uint32_t m_layout_version = 0;
+
+  // Interpolation state. The previous matrices only line up with the
+  // current ones while the dense layout is unchanged.
+  std::vector<glm::mat4> m_previous_world_matrices;
+  std::vector<glm::mat4> m_render_matrices;
+  uint32_t m_previous_layout_version = 0;
+  bool m_interpolated = false;
+
+  // Per-update scratch: whether a dense entry's world matrix changed.
+  std::vector<uint8_t> m_world_changed;
+};
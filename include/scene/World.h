@@ -0,0 +1,236 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// A 32-bit entity id. The low INDEX_BITS select the entity's record, the
+// remaining bits are a generation that detects ids of destroyed entities.
+struct Entity {
+  static constexpr uint32_t INDEX_BITS = 22; // Up to ~4M live entities
+  static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+  static constexpr uint32_t INVALID_ID = UINT32_MAX;
+
+  uint32_t id = INVALID_ID;
+
+  uint32_t index() const { return id & INDEX_MASK; }
+  uint32_t generation() const { return id >> INDEX_BITS; }
+  bool is_valid() const { return id != INVALID_ID; }
+
+  bool operator==(Entity other) const { return id == other.id; }
+  bool operator!=(Entity other) const { return id != other.id; }
+};
+
+// Archetype-based entity/component storage. Entities with the same set of
+// data types (their signature) share an archetype, whose data lives in
+// CHUNK_SIZE blocks: an array of entity ids followed by one tightly packed
+// array per type. Queries visit only matching archetypes and hand out whole
+// arrays, so iterating a million entities is a linear walk over memory.
+//
+// Types must be nothrow move-constructible; adding or removing a type moves
+// the entity to another archetype. Any pointer obtained from get() or a
+// query is invalidated by the next add, remove, create or destroy.
+// Not thread-safe: mutate from one thread, and don't mutate during a query.
+class World {
+public:
+  static constexpr size_t CHUNK_SIZE = 16 * 1024;
+  static constexpr uint32_t MAX_TYPES = 64;
+
+  // Shared world that holds entities of objects not yet added to a scene.
+  static std::shared_ptr<World> detached();
+
+  World();
+  ~World();
+
+  World(const World &) = delete;
+  World &operator=(const World &) = delete;
+
+  Entity create();
+  void destroy(Entity entity);
+  bool is_alive(Entity entity) const;
+  // Number of live entities.
+  size_t size() const { return m_live_count; }
+
+  // Changes whenever any entity changes archetype or row, i.e. on every
+  // create, destroy, add or remove of a new type. While it stays the same,
+  // queries visit the same entities in the same order.
+  uint32_t get_layout_version() const { return m_layout_version; }
+
+  // Moves `entity` and all of its data into `dest` and returns its new id
+  // there. The old id becomes invalid.
+  Entity move_to(Entity entity, World &dest);
+
+  // Adds (or replaces) the entity's T.
+  template <typename T, typename... Args> T &add(Entity entity, Args &&...args) {
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "World types must be nothrow move-constructible");
+    // Construct before moving so a throwing constructor leaves no hole.
+    T value(std::forward<Args>(args)...);
+    const uint32_t type = type_id<T>();
+    Record &record = m_records[entity.index()];
+    if (m_archetypes[record.archetype]->column[type] == NO_COLUMN) {
+      move_entity(entity.index(), archetype_edge(record.archetype, type, true),
+                  type);
+      return *new (column_address(record, type)) T(std::move(value));
+    }
+    T &existing = *static_cast<T *>(column_address(record, type));
+    existing = std::move(value);
+    return existing;
+  }
+
+  template <typename T> void remove(Entity entity) {
+    const uint32_t type = type_id<T>();
+    Record &record = m_records[entity.index()];
+    if (m_archetypes[record.archetype]->column[type] != NO_COLUMN) {
+      move_entity(entity.index(),
+                  archetype_edge(record.archetype, type, false), NO_TYPE);
+    }
+  }
+
+  template <typename T> bool has(Entity entity) const {
+    const Record &record = m_records[entity.index()];
+    return m_archetypes[record.archetype]->column[type_id<T>()] != NO_COLUMN;
+  }
+
+  // Returns the entity's T, or nullptr if it has none.
+  template <typename T> T *get(Entity entity) {
+    return has<T>(entity) ? static_cast<T *>(column_address(
+                                m_records[entity.index()], type_id<T>()))
+                          : nullptr;
+  }
+  template <typename T> const T *get(Entity entity) const {
+    return const_cast<World *>(this)->get<T>(entity);
+  }
+
+  // Calls func(count, entities, Ts *...) once per chunk of entities that have
+  // every type in Ts. The arrays all hold `count` elements.
+  template <typename... Ts, typename Func> void each_chunk(Func &&func) {
+    const uint64_t mask = signature_of<std::remove_const_t<Ts>...>();
+    for (const auto &archetype : m_archetypes) {
+      if ((archetype->signature & mask) != mask) {
+        continue;
+      }
+      for (size_t c = 0; c < archetype->chunks.size(); ++c) {
+        unsigned char *data = archetype->chunks[c]->data;
+        func(chunk_count(*archetype, c),
+             reinterpret_cast<const Entity *>(data),
+             reinterpret_cast<Ts *>(
+                 data + column_offset<std::remove_const_t<Ts>>(*archetype))...);
+      }
+    }
+  }
+  // Read-only queries on a const World; every T must be const.
+  template <typename... Ts, typename Func> void each_chunk(Func &&func) const {
+    static_assert((std::is_const_v<Ts> && ...),
+                  "Queries on a const World must use const types");
+    const_cast<World *>(this)->each_chunk<Ts...>(std::forward<Func>(func));
+  }
+
+  // Calls func(entity, Ts &...) for every entity that has all of Ts.
+  template <typename... Ts, typename Func> void each(Func &&func) {
+    each_chunk<Ts...>([&func](uint32_t count, const Entity *entities,
+                              Ts *...columns) {
+      for (uint32_t i = 0; i < count; ++i) {
+        func(entities[i], columns[i]...);
+      }
+    });
+  }
+  template <typename... Ts, typename Func> void each(Func &&func) const {
+    static_assert((std::is_const_v<Ts> && ...),
+                  "Queries on a const World must use const types");
+    const_cast<World *>(this)->each<Ts...>(std::forward<Func>(func));
+  }
+
+  // Small dense id per data type, shared by every World.
+  template <typename T> static uint32_t type_id() {
+    using Type = std::remove_cv_t<T>;
+    static const uint32_t s_id = register_type(TypeInfo{
+        sizeof(Type), alignof(Type),
+        [](void *dst, void *src) {
+          new (dst) Type(std::move(*static_cast<Type *>(src)));
+        },
+        [](void *ptr) { static_cast<Type *>(ptr)->~Type(); }});
+    return s_id;
+  }
+
+private:
+  static constexpr uint8_t NO_COLUMN = UINT8_MAX;
+  static constexpr uint32_t NO_TYPE = UINT32_MAX;
+  static constexpr uint32_t NO_ARCHETYPE = UINT32_MAX;
+
+  struct TypeInfo {
+    size_t size;
+    size_t align;
+    void (*move)(void *dst, void *src); // Move-construct dst from src
+    void (*destroy)(void *ptr);
+  };
+
+  struct Chunk {
+    alignas(64) unsigned char data[CHUNK_SIZE];
+  };
+
+  struct Archetype {
+    uint64_t signature = 0;
+    std::vector<uint32_t> types;   // Type ids, ascending
+    std::vector<uint32_t> offsets; // Byte offset of each type's array
+    std::array<uint8_t, MAX_TYPES> column; // Type id -> index into types
+    uint32_t capacity = 0;                 // Entities per chunk
+    uint32_t size = 0;                     // Entities in this archetype
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    // Cached archetype for this signature plus/minus one type.
+    std::array<uint32_t, MAX_TYPES> add_edge;
+    std::array<uint32_t, MAX_TYPES> remove_edge;
+  };
+
+  struct Record {
+    uint32_t archetype = 0;
+    uint32_t row = 0; // Global row; chunk = row / capacity
+    uint32_t generation = 0;
+  };
+
+  static uint32_t register_type(const TypeInfo &info);
+  static std::array<TypeInfo, MAX_TYPES> s_types;
+  static std::atomic<uint32_t> s_type_count;
+
+  template <typename... Ts> static uint64_t signature_of() {
+    return ((uint64_t(1) << type_id<Ts>()) | ... | uint64_t(0));
+  }
+  template <typename T> static size_t column_offset(const Archetype &archetype) {
+    return archetype.offsets[archetype.column[type_id<T>()]];
+  }
+  static uint32_t chunk_count(const Archetype &archetype, size_t chunk) {
+    const size_t begin = chunk * archetype.capacity;
+    const size_t remaining = archetype.size - begin;
+    return static_cast<uint32_t>(
+        remaining < archetype.capacity ? remaining : archetype.capacity);
+  }
+
+  uint32_t find_or_create_archetype(uint64_t signature);
+  uint32_t archetype_edge(uint32_t from, uint32_t type, bool add);
+
+  uint32_t allocate_row(Archetype &archetype, Entity entity);
+  // Fills the hole at `row` (already destroyed or moved out) with the last
+  // row and shrinks the archetype.
+  void remove_row(Archetype &archetype, uint32_t row);
+  // Moves the entity at record `index` to archetype `dest`. Types missing
+  // from `dest` are destroyed; `skip_type` is left unconstructed in `dest`.
+  void move_entity(uint32_t index, uint32_t dest, uint32_t skip_type);
+
+  unsigned char *row_address(const Archetype &archetype, uint32_t row) const;
+  void *column_address(const Record &record, uint32_t type);
+  Entity &entity_at(const Archetype &archetype, uint32_t row);
+
+  std::vector<std::unique_ptr<Archetype>> m_archetypes;
+  std::unordered_map<uint64_t, uint32_t> m_archetype_lookup;
+
+  std::vector<Record> m_records;
+  std::vector<uint32_t> m_free_records;
+  size_t m_live_count = 0;
+  uint32_t m_layout_version = 0;
+};
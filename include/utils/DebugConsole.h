@@ -24,6 +24,8 @@ public:
 
 private:
   void execute_command(const std::string &command);
+  // Table of GpuProfiler results.
+  void draw_gpu_timings();
 
   static int text_edit_callback(ImGuiInputTextCallbackData *data);
 
@@ -32,5 +34,6 @@ private:
   std::vector<std::string> m_command_history;
   int m_history_pos;
   bool m_is_visible;
+  bool m_initialized; // False until init(), e.g. when running headless
   std::function<void(const std::string &)> m_command_callback;
 };
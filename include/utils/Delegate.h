@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, size_t InlineSize = 32> class Delegate;
+
+// A move-only std::function replacement. Callables up to InlineSize bytes
+// (a lambda capturing a few pointers, a bound member function) are stored
+// inline, larger ones on the heap. A call is one indirect function call.
+template <typename R, typename... Args, size_t InlineSize>
+class Delegate<R(Args...), InlineSize> {
+public:
+  Delegate() = default;
+
+  template <typename F, typename = std::enable_if_t<
+                            !std::is_same_v<std::decay_t<F>, Delegate>>>
+  Delegate(F &&callable) {
+    using Callable = std::decay_t<F>;
+    if constexpr (fits_inline<Callable>()) {
+      new (m_storage) Callable(std::forward<F>(callable));
+      m_invoke = [](void *storage, Args... args) -> R {
+        return (*static_cast<Callable *>(storage))(
+            std::forward<Args>(args)...);
+      };
+      m_manage = [](void *dst, void *src) {
+        auto *from = static_cast<Callable *>(src);
+        if (dst) {
+          new (dst) Callable(std::move(*from));
+        }
+        from->~Callable();
+      };
+    } else {
+      *reinterpret_cast<Callable **>(m_storage) =
+          new Callable(std::forward<F>(callable));
+      m_invoke = [](void *storage, Args... args) -> R {
+        return (**static_cast<Callable **>(storage))(
+            std::forward<Args>(args)...);
+      };
+      m_manage = [](void *dst, void *src) {
+        auto **from = static_cast<Callable **>(src);
+        if (dst) {
+          *static_cast<Callable **>(dst) = *from;
+        } else {
+          delete *from;
+        }
+      };
+    }
+  }
+
+  Delegate(Delegate &&other) noexcept { move_from(other); }
+  Delegate &operator=(Delegate &&other) noexcept {
+    if (this != &other) {
+      reset();
+      move_from(other);
+    }
+    return *this;
+  }
+  Delegate(const Delegate &) = delete;
+  Delegate &operator=(const Delegate &) = delete;
+
+  ~Delegate() { reset(); }
+
+  R operator()(Args... args) const {
+    return m_invoke(const_cast<unsigned char *>(m_storage),
+                    std::forward<Args>(args)...);
+  }
+
+  explicit operator bool() const { return m_invoke != nullptr; }
+
+  void reset() {
+    if (m_manage) {
+      m_manage(nullptr, m_storage);
+    }
+    m_invoke = nullptr;
+    m_manage = nullptr;
+  }
+
+private:
+  template <typename Callable> static constexpr bool fits_inline() {
+    return sizeof(Callable) <= InlineSize &&
+           alignof(Callable) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible_v<Callable>;
+  }
+
+  void move_from(Delegate &other) {
+    if (other.m_manage) {
+      other.m_manage(m_storage, other.m_storage);
+    }
+    m_invoke = other.m_invoke;
+    m_manage = other.m_manage;
+    other.m_invoke = nullptr;
+    other.m_manage = nullptr;
+  }
+
+  // Moves the callable from src into dst and destroys src's; with a null
+  // dst, just destroys src's.
+  using Manage = void (*)(void *dst, void *src);
+  using Invoke = R (*)(void *storage, Args... args);
+
+  Invoke m_invoke = nullptr;
+  Manage m_manage = nullptr;
+  alignas(std::max_align_t) unsigned char m_storage[InlineSize];
+};
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+// Small, fast string hashes that can run at compile time.
+class Hash {
+public:
+  // This class is not meant to be instantiated.
+  Hash() = delete;
+
+  // 32-bit FNV-1a.
+  static constexpr uint32_t fnv1a(std::string_view text) {
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (char c : text) {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= FNV_PRIME;
+    }
+    return hash;
+  }
+
+private:
+  static constexpr uint32_t FNV_OFFSET_BASIS = 2166136261u;
+  static constexpr uint32_t FNV_PRIME = 16777619u;
+};
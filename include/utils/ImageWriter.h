@@ -0,0 +1,24 @@
+#pragma once
+#include <ostream>
+#include <string>
+
+// Encoders for captured frames. Pixels are tightly packed RGBA8 rows, top
+// row first.
+class ImageWriter {
+public:
+  // This class is not meant to be instantiated.
+  ImageWriter() = delete;
+
+  // Writes an 8-bit RGBA PNG. Compressed with zlib when the build has it
+  // (HAS_ZLIB), otherwise stored uncompressed inside the PNG.
+  static bool write_png(const std::string &path, unsigned int width,
+                        unsigned int height, const unsigned char *pixels);
+
+  // YUV4MPEG2 (.y4m) stream with 4:4:4 BT.601 video-range samples, readable
+  // by ffmpeg and most encoders. Write the header once, then each frame.
+  static void write_y4m_header(std::ostream &out, unsigned int width,
+                               unsigned int height, unsigned int fps);
+  static void write_y4m_frame(std::ostream &out, unsigned int width,
+                              unsigned int height,
+                              const unsigned char *pixels);
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#if defined(ENABLE_PROFILER) && (defined(__x86_64__) || defined(_M_X64))
+#define PROFILER_USE_TSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// CPU zone profiler. A zone records when a scope was entered and left into
+// a ring buffer owned by the calling thread, so recording takes no lock and
+// costs two timestamp reads. write_chrome_trace() exports the zones still
+// in the rings as Chrome trace-event JSON (chrome://tracing, Perfetto).
+//
+//   void Scene::update(float dt) {
+//     PROFILE_FUNCTION();
+//     { PROFILE_ZONE("bounds"); ... }
+//   }
+//
+// Zone names must outlive the profiler (string literals). Built only with
+// ENABLE_PROFILER; otherwise the macros expand to nothing.
+class Profiler {
+public:
+  // This class is not meant to be instantiated.
+  Profiler() = delete;
+
+  // Zones each thread keeps; older ones are overwritten.
+  static constexpr uint32_t RING_CAPACITY = 1u << 15;
+
+  // Ticks of now(): TSC cycles on x86-64, steady_clock nanoseconds elsewhere.
+  static uint64_t now() {
+#ifdef PROFILER_USE_TSC
+    return __rdtsc();
+#else
+    return now_steady();
+#endif
+  }
+
+  static void record(const char *name, uint64_t start, uint64_t end);
+  // Names the calling thread in exported traces.
+  static void set_thread_name(const char *name);
+
+  // Writes every zone still held by any thread's ring. Zones being written
+  // while the export runs are skipped.
+  static bool write_chrome_trace(const std::string &path);
+  // Drops all recorded zones.
+  static void clear();
+
+  static bool is_compiled_in() {
+#ifdef ENABLE_PROFILER
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  class Zone {
+  public:
+    explicit Zone(const char *name) : m_name(name), m_start(now()) {}
+    ~Zone() { record(m_name, m_start, now()); }
+    Zone(const Zone &) = delete;
+    Zone &operator=(const Zone &) = delete;
+
+  private:
+    const char *m_name;
+    uint64_t m_start;
+  };
+
+private:
+  static uint64_t now_steady();
+};
+
+#ifdef ENABLE_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name)                                                     \
+  Profiler::Zone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+#define PROFILE_THREAD_NAME(name) Profiler::set_thread_name(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#endif
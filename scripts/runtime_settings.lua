@@ -7,6 +7,7 @@ function load_shaders()
 	ResourceManager.load_shader("box_test", ShaderType.Graphics, { "shaders/canvas.vert", "shaders/box_test.frag" })
 	ResourceManager.load_shader("compute_test", ShaderType.Compute, { "shaders/texture_compute.comp" })
 	ResourceManager.load_shader("draw_texture", ShaderType.Graphics, { "shaders/canvas.vert", "shaders/shader.frag" })
+	ResourceManager.load_shader("cull", ShaderType.Compute, { "shaders/cull.comp" })
 end
 
 -- This function takes the C++ Config object and sets values on it.
@@ -19,6 +20,8 @@ function configure_renderer(config)
 	-- GraphicsRenderer settings
 	config.graphics_main_shader_name = "default"
 	config.graphics_canvas_shader_name = "canvas_alt"
+	config.graphics_gpu_driven = false
+	config.graphics_cull_shader_name = "cull"
 
 	-- CanvasRenderer settings
 	config.canvas_shader_name = "canvas"
@@ -45,5 +45,13 @@ function build_scene(scene)
 	sphere_object.transform.position = vec3.new(0.0, 1.5, 0.0)
 	scene:add_object(sphere_object)
 
+	-- Object 5: Small cube attached to the rotating cube, orbiting with it.
+	-- Parenting requires both objects to already be in the scene.
+	local satellite_object = SceneObject.new(cube_mesh)
+	satellite_object.transform.position = vec3.new(0.0, 1.0, 0.0)
+	satellite_object.transform.scale = vec3.new(0.3)
+	scene:add_object(satellite_object)
+	satellite_object:set_parent(rotating_object)
+
 	print("[Lua] Scene construction complete.")
 end
@@ -1,17 +1,24 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 2) in vec2 aTexCoord;
+// Per-instance model matrix (occupies locations 3-6)
+layout (location = 3) in mat4 aModel;
 
 // Outputs
 out vec2 TexCoord;
 
-// Uniforms
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Shared per-frame data (see FrameUniforms.h)
+layout (std140) uniform FrameData {
+    mat4 u_view;
+    mat4 u_projection;
+    mat4 u_view_projection;
+    vec2 u_resolution;
+    float u_time;
+    float u_delta_time;
+};
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = u_view_projection * aModel * vec4(aPos, 1.0);
     TexCoord = aTexCoord;
 }
@@ -1,13 +1,20 @@
 #include "core/Application.h"
 #include "core/Input.h"
+#include "core/JobSystem.h"
 #include "core/ScriptingContext.h"
 #include "core/Settings.h"
 #include "core/Time.h"
 #include "core/Window.h"
 #include "core/events/AppEvent.h"
 #include "core/events/EventDispatcher.h"
+#include "core/events/EventRecorder.h"
 #include "core/events/KeyEvent.h"
 #include "core/events/MouseEvent.h"
+#include "graphics/FrameCapture.h"
+#include "graphics/FrameUniforms.h"
+#include "graphics/GeometryArena.h"
+#include "graphics/GLState.h"
+#include "graphics/GpuProfiler.h"
 #include "graphics/renderers/CanvasRenderer.h"
 #include "graphics/renderers/ComputeRenderer.h"
 #include "graphics/renderers/GraphicsRenderer.h"
@@ -15,24 +22,47 @@
 #include "scene/Scene.h"
 #include "utils/DebugConsole.h"
 #include "utils/Log.h"
+#include "utils/Profiler.h"
 #include "utils/ResourceManager.h"
 #include "utils/ScriptingManager.h"
 
 #include <GLFW/glfw3.h>
+#include <functional>
 
-Application::Application() {
+Application::Application(std::vector<std::string> arguments)
+    : m_arguments(std::move(arguments)) {
   m_window = std::make_unique<Window>();
   m_settings = std::make_unique<Settings>();
   m_active_scene = std::make_unique<Scene>();
   m_scripting_context = std::make_unique<ScriptingContext>();
   m_console = std::make_unique<DebugConsole>();
+  m_capture = std::make_unique<FrameCapture>();
+  m_recorder = std::make_unique<EventRecorder>();
 
   subscribe_to_events();
 }
 
-Application::~Application() { ResourceManager::clear(); };
+Application::~Application() {
+  m_recorder->stop();
+  // Finishes readbacks still in flight while the GL context is alive.
+  m_capture->shutdown();
+  const std::string &profile_path = m_settings->get_config().gpu_profile_path;
+  if (!profile_path.empty()) {
+    GpuProfiler::write_json(profile_path);
+  }
+  const std::string &trace_path = m_settings->get_config().cpu_trace_path;
+  if (!trace_path.empty()) {
+    Profiler::write_chrome_trace(trace_path);
+  }
+  GpuProfiler::shutdown();
+  ResourceManager::clear();
+  FrameUniforms::shutdown();
+  GeometryArena::shutdown();
+  JobSystem::shutdown();
+};
 
 void Application::process_script_commands() {
+  PROFILE_FUNCTION();
   // Create a temporary copy of commands to process
   std::vector<std::string> commands_to_run;
   {
@@ -84,30 +114,45 @@ void Application::on_key_pressed(KeyPressedEvent &event) {
 }
 
 void Application::run() {
+  PROFILE_THREAD_NAME("main");
+
   // 1. Load critical settings TOML.
   m_settings->load("settings.toml");
+  m_settings->apply_arguments(m_arguments);
 
   // 2. Initialize the window and OpenGL context
   // ‼️ We need a mutable reference to config now.
   // TODO: Do not use a mutable reference to config. Implement functions to make
   // this safer.
   auto &config = m_settings->get_mutable_config();
-  if (!m_window->init(config.window_width, config.window_height,
-                      config.window_title.c_str(), config.window_resizable,
-                      config.window_transparent)) {
+  const bool window_ready =
+      config.headless
+          ? m_window->init_headless(config.window_width, config.window_height,
+                                    config.headless_frames)
+          : m_window->init(config.window_width, config.window_height,
+                           config.window_title.c_str(),
+                           config.window_resizable, config.window_transparent);
+  if (!window_ready) {
     Log::error("Failed to initialize window!");
     return;
   }
 
-  m_console->init(m_window->get_glfw_window());
+  FrameUniforms::init();
+  // The console needs a real window for ImGui's input.
+  if (!m_window->is_headless()) {
+    m_console->init(m_window->get_glfw_window());
+  }
   m_console->set_command_callback([this](const std::string &command) {
     std::lock_guard<std::mutex> lock(m_command_mutex);
     m_command_queue.push_back(command);
   });
 
+  JobSystem::init(config.worker_threads);
+
   // 3. Initialize scripting.
   ScriptingManager::init();
   m_scripting_context->scene = m_active_scene.get();
+  m_scripting_context->capture = m_capture.get();
 
   // Load runtime settings to finalize the config.
   Log::info("--- Loading Runtime Scripts ---");
@@ -149,35 +194,100 @@ void Application::run() {
   }
   Log::info("--- Script Loading Complete ---");
 
-  // 6. Initialize time.
+  // 6. Initialize time. A replay runs at the recording's frame rate, one
+  // fixed step per frame, so its events land on the same simulation times.
+  if (!config.replay_path.empty()) {
+    float recorded_fps;
+    if (m_recorder->start_replay(config.replay_path, recorded_fps)) {
+      config.fps = recorded_fps;
+      Time::set_fixed_step(true);
+    }
+  } else if (!config.record_path.empty()) {
+    m_recorder->start_recording(config.record_path, config.fps);
+  }
   Time::init(config.fps);
+  Time::set_fixed_update(config.fixed_update_hz, config.max_fixed_steps);
+
+  if (config.capture_frames > 0) {
+    CaptureFormat format;
+    if (FrameCapture::parse_format(config.capture_format, format)) {
+      m_capture->start(config.capture_frames, format, config.capture_path,
+                       static_cast<unsigned int>(config.fps));
+    } else {
+      Log::warn("Unknown capture format '" + config.capture_format + "'.");
+    }
+  }
 
   // --- MAIN LOOP ---
   Input *input = m_window->get_input();
   Log::debug("Starting main loop");
   while (!m_window->should_close()) {
+    PROFILE_ZONE("frame");
     Time::begin_frame();
 
     double delta_time = Time::get_delta_time();
 
     process_script_commands();
-    m_window->poll_events();
-
-    EventDispatcher::dispatch_events();
+    {
+      PROFILE_ZONE("poll_events");
+      m_window->poll_events();
+    }
+    {
+      PROFILE_ZONE("dispatch_events");
+      EventDispatcher::dispatch_events();
+      m_recorder->end_dispatch();
+    }
     if (m_window->should_close()) {
       break;
     }
     // Update all object and their components in the scene
-    m_active_scene->update(delta_time);
+    if (Time::is_fixed_update()) {
+      TransformStore &transforms = m_active_scene->get_transform_store();
+      while (Time::next_fixed_step()) {
+        transforms.store_previous_world_matrices();
+        m_active_scene->update(static_cast<float>(Time::get_fixed_delta()));
+      }
+      m_active_scene->interpolate(Time::get_interpolation_alpha());
+    } else {
+      m_active_scene->update(delta_time);
+    }
 
-    // Render
-    m_renderer->update(delta_time);
-    m_renderer->draw(*m_active_scene, m_window->get_width(),
-                     m_window->get_height());
-    m_console->draw();
+    // Render. Third-party code (ImGui) may have changed GL bindings since
+    // the last frame, so don't trust the cached ones.
+    GLState::invalidate();
+    GpuProfiler::begin_frame();
+    FrameUniforms::begin_frame(static_cast<float>(Time::get_total_time()),
+                               static_cast<float>(delta_time),
+                               m_window->get_width(), m_window->get_height());
+    {
+      PROFILE_ZONE("renderer_update");
+      m_renderer->update(delta_time);
+    }
+    {
+      PROFILE_ZONE("renderer_draw");
+      m_renderer->draw(*m_active_scene, m_window->get_width(),
+                       m_window->get_height());
+    }
+    // Before the console so the overlay stays out of captured frames.
+    m_capture->capture(m_window->get_framebuffer(), m_window->get_width(),
+                       m_window->get_height());
+    {
+      PROFILE_ZONE("console_draw");
+      m_console->draw();
+    }
+    GpuProfiler::end_frame();
 
-    m_window->swap_buffers();
+    {
+      PROFILE_ZONE("swap_buffers");
+      m_window->swap_buffers();
+    }
     input->update();
-    Time::end_frame();
+    if (m_recorder->is_replay_finished()) {
+      m_window->set_should_close(true);
+    }
+    {
+      PROFILE_ZONE("frame_limiter");
+      Time::end_frame();
+    }
   }
 }
@@ -1,10 +1,18 @@
 #include "core/Input.h"
-#include "core/Window.h"
 #include "core/events/EventDispatcher.h"
 #include "core/events/KeyEvent.h"
 #include <cstring>
 
-Input::Input(GLFWwindow *window) : m_window(window) {}
+Input::Input(GLFWwindow *window) : m_window(window) {
+  m_subscriptions.push_back(EventDispatcher::subscribe<KeyPressedEvent>(
+      [this](KeyPressedEvent &event) {
+        set_key_state(event.get_key_code(), true);
+      }));
+  m_subscriptions.push_back(EventDispatcher::subscribe<KeyReleasedEvent>(
+      [this](KeyReleasedEvent &event) {
+        set_key_state(event.get_key_code(), false);
+      }));
+}
 
 void Input::update() {
   memcpy(m_previous_key_states, m_current_key_states,
@@ -15,35 +23,15 @@ void Input::update() {
 void Input::key_callback(GLFWwindow *window, int key, int scancode, int action,
                          int mods) {
   if (action == GLFW_PRESS) {
-    EventDispatcher::queue_event(std::make_unique<KeyPressedEvent>(key));
+    EventDispatcher::post<KeyPressedEvent>(key);
   } else if (action == GLFW_RELEASE) {
-    EventDispatcher::queue_event(std::make_unique<KeyReleasedEvent>(key));
-  }
-
-  // The rest of this function can remain to update the internal state for
-  // is_key_down() polling, as both systems can coexist.
-
-  // 1. Retrieve the Window instance from the user pointer
-  Window *window_instance =
-      static_cast<Window *>(glfwGetWindowUserPointer(window));
-
-  // 2. Get the Input handler from the Window instance
-  if (window_instance) {
-    Input *input_handler = window_instance->get_input();
-    if (input_handler) {
-      input_handler->key_callback_impl(key, action);
-    }
+    EventDispatcher::post<KeyReleasedEvent>(key);
   }
 }
 
-// Instance-specific implementation of the callback logic
-void Input::key_callback_impl(int key, int action) {
+void Input::set_key_state(int key, bool down) {
   if (key >= 0 && key <= GLFW_KEY_LAST) {
-    if (action == GLFW_PRESS) {
-      m_current_key_states[key] = true;
-    } else if (action == GLFW_RELEASE) {
-      m_current_key_states[key] = false;
-    }
+    m_current_key_states[key] = down;
   }
 }
 
@@ -0,0 +1,188 @@
+#include "core/JobSystem.h"
+#include "utils/Log.h"
+#include "utils/Profiler.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+struct Job {
+  JobSystem::ChunkFunction function;
+  void *context;
+  size_t begin;
+  size_t end;
+  std::atomic<size_t> *remaining;
+};
+
+// The owner pushes and pops at the back; thieves take from the front so they
+// grab the oldest (and usually largest remaining) work.
+struct WorkQueue {
+  std::mutex mutex;
+  std::deque<Job> jobs;
+
+  void push(const Job &job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back(job);
+  }
+
+  bool pop(Job &job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (jobs.empty()) {
+      return false;
+    }
+    job = jobs.back();
+    jobs.pop_back();
+    return true;
+  }
+
+  bool steal(Job &job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (jobs.empty()) {
+      return false;
+    }
+    job = jobs.front();
+    jobs.pop_front();
+    return true;
+  }
+};
+
+// Queue 0 belongs to whichever thread submits work (normally the main
+// thread); queues 1..N belong to the workers.
+std::vector<std::unique_ptr<WorkQueue>> s_queues;
+std::vector<std::thread> s_workers;
+std::atomic<size_t> s_queued_jobs{0};
+std::atomic<bool> s_running{false};
+std::mutex s_sleep_mutex;
+std::condition_variable s_wake_condition;
+
+thread_local size_t t_queue_index = 0;
+
+bool find_job(Job &job) {
+  if (s_queues[t_queue_index]->pop(job)) {
+    return true;
+  }
+  // Own queue is empty: try to steal, starting with our neighbour so thieves
+  // spread out over the victims.
+  const size_t queue_count = s_queues.size();
+  for (size_t i = 1; i < queue_count; ++i) {
+    if (s_queues[(t_queue_index + i) % queue_count]->steal(job)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void execute(const Job &job) {
+  PROFILE_ZONE("job");
+  s_queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+  job.function(job.context, job.begin, job.end);
+  job.remaining->fetch_sub(1, std::memory_order_release);
+}
+
+void worker_loop(size_t queue_index) {
+  t_queue_index = queue_index;
+  PROFILE_THREAD_NAME(("worker " + std::to_string(queue_index)).c_str());
+  while (s_running.load(std::memory_order_acquire)) {
+    Job job;
+    if (find_job(job)) {
+      execute(job);
+      continue;
+    }
+    // Nothing to do anywhere: sleep until new work is queued.
+    std::unique_lock<std::mutex> lock(s_sleep_mutex);
+    s_wake_condition.wait(lock, [] {
+      return s_queued_jobs.load(std::memory_order_acquire) > 0 ||
+             !s_running.load(std::memory_order_acquire);
+    });
+  }
+}
+} // namespace
+
+void JobSystem::init(unsigned int worker_count) {
+  if (s_running) {
+    Log::warn("JobSystem already initialized.");
+    return;
+  }
+  if (worker_count == 0) {
+    unsigned int hardware_threads = std::thread::hardware_concurrency();
+    worker_count = hardware_threads > 1 ? hardware_threads - 1 : 0;
+  }
+
+  s_queues.clear();
+  for (unsigned int i = 0; i <= worker_count; ++i) {
+    s_queues.push_back(std::make_unique<WorkQueue>());
+  }
+
+  s_running = true;
+  for (unsigned int i = 0; i < worker_count; ++i) {
+    s_workers.emplace_back(worker_loop, i + 1);
+  }
+  Log::info("JobSystem started with " + std::to_string(worker_count) +
+            " worker threads.");
+}
+
+void JobSystem::shutdown() {
+  if (!s_running) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(s_sleep_mutex);
+    s_running = false;
+  }
+  s_wake_condition.notify_all();
+  for (auto &worker : s_workers) {
+    worker.join();
+  }
+  s_workers.clear();
+  s_queues.clear();
+}
+
+unsigned int JobSystem::get_worker_count() {
+  return static_cast<unsigned int>(s_workers.size());
+}
+
+void JobSystem::run_chunks(size_t count, size_t chunk_size,
+                           ChunkFunction function, void *context) {
+  if (count == 0) {
+    return;
+  }
+  if (chunk_size == 0) {
+    chunk_size = 1;
+  }
+  if (s_workers.empty() || count <= chunk_size) {
+    function(context, 0, count);
+    return;
+  }
+
+  // Deal the chunks out round-robin so every worker starts with local work.
+  const size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+  std::atomic<size_t> remaining{chunk_count};
+  const size_t queue_count = s_queues.size();
+  for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+    size_t begin = chunk * chunk_size;
+    size_t end = begin + chunk_size < count ? begin + chunk_size : count;
+    s_queues[(t_queue_index + chunk) % queue_count]->push(
+        Job{function, context, begin, end, &remaining});
+  }
+  {
+    // Publish under the sleep mutex so a worker can't miss the wake-up
+    // between checking its predicate and going to sleep.
+    std::lock_guard<std::mutex> lock(s_sleep_mutex);
+    s_queued_jobs.fetch_add(chunk_count, std::memory_order_release);
+  }
+  s_wake_condition.notify_all();
+
+  // Help until every chunk (including ones stolen by workers) has finished.
+  while (remaining.load(std::memory_order_acquire) > 0) {
+    Job job;
+    if (find_job(job)) {
+      execute(job);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
@@ -19,7 +19,16 @@ bool Settings::load(const std::string &filepath) {
         tbl["window"]["resizable"].value_or(m_config.window_resizable);
     m_config.window_transparent =
         tbl["window"]["transparent"].value_or(m_config.window_transparent);
+    m_config.headless = tbl["headless"]["enabled"].value_or(m_config.headless);
+    m_config.headless_frames =
+        tbl["headless"]["frames"].value_or(m_config.headless_frames);
     m_config.fps = tbl["performance"]["fps"].value_or(m_config.fps);
+    m_config.worker_threads = tbl["performance"]["worker_threads"].value_or(
+        m_config.worker_threads);
+    m_config.fixed_update_hz = tbl["simulation"]["fixed_update_hz"].value_or(
+        m_config.fixed_update_hz);
+    m_config.max_fixed_steps = tbl["simulation"]["max_fixed_steps"].value_or(
+        m_config.max_fixed_steps);
 
     Log::info("Settings loaded successfully from " + filepath);
     return true;
@@ -35,6 +44,36 @@ bool Settings::load(const std::string &filepath) {
   }
 }
 
+void Settings::apply_arguments(const std::vector<std::string> &arguments) {
+  for (size_t i = 0; i < arguments.size(); ++i) {
+    const std::string &argument = arguments[i];
+    const bool has_value = i + 1 < arguments.size();
+    if (argument == "--capture" && has_value) {
+      try {
+        m_config.capture_frames =
+            static_cast<unsigned int>(std::stoul(arguments[++i]));
+      } catch (const std::exception &) {
+        Log::warn("--capture expects a frame count, got '" + arguments[i] +
+                  "'.");
+      }
+    } else if (argument == "--capture-format" && has_value) {
+      m_config.capture_format = arguments[++i];
+    } else if (argument == "--capture-path" && has_value) {
+      m_config.capture_path = arguments[++i];
+    } else if (argument == "--gpu-profile" && has_value) {
+      m_config.gpu_profile_path = arguments[++i];
+    } else if (argument == "--cpu-trace" && has_value) {
+      m_config.cpu_trace_path = arguments[++i];
+    } else if (argument == "--record" && has_value) {
+      m_config.record_path = arguments[++i];
+    } else if (argument == "--replay" && has_value) {
+      m_config.replay_path = arguments[++i];
+    } else {
+      Log::warn("Ignoring unknown or incomplete argument '" + argument + "'.");
+    }
+  }
+}
+
 const Config &Settings::get_config() const { return m_config; }
 
 Config &Settings::get_mutable_config() { return m_config; }
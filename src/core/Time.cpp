@@ -1,75 +1,135 @@
 #include "core/Time.h"
 #include "utils/Log.h"
-#include <GLFW/glfw3.h> // For glfwGetTime()
 #include <chrono>
+#include <cmath>
 #include <thread>
 
+namespace {
+// Nanoseconds on a monotonic clock. Not glfwGetTime(): headless runs never
+// initialize GLFW.
+int64_t now() {
+  static const auto s_start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - s_start)
+      .count();
+}
+} // namespace
+
 float Time::s_target_fps = 60.0f;
-double Time::s_target_frame_time = 1.0 / 60.0;
-double Time::s_frame_start_time = 0.0;
-double Time::s_last_frame_time = 0.0;
+int64_t Time::s_target_frame_ticks = Time::TICKS_PER_SECOND / 60;
+int64_t Time::s_frame_start_ticks = 0;
+int64_t Time::s_last_frame_ticks = 0;
 double Time::s_delta_time = 0.0;
-double Time::s_last_fps_time = 0.0;
+int64_t Time::s_last_fps_ticks = 0;
 int Time::s_frame_count = 0;
 int Time::s_missed_frames_count = 0;
 
-double Time::s_total_time = 0.0;
+int64_t Time::s_total_ticks = 0;
+bool Time::s_fixed_step = false;
+
+int64_t Time::s_fixed_step_ticks = 0;
+unsigned int Time::s_max_steps = 5;
+unsigned int Time::s_steps_this_frame = 0;
+int64_t Time::s_accumulator_ticks = 0;
+int64_t Time::s_simulation_ticks = 0;
+int Time::s_dropped_steps_count = 0;
 
 void Time::init(float target_fps) {
   s_target_fps = target_fps;
-  s_target_frame_time = 1.0 / target_fps;
+  s_target_frame_ticks =
+      std::llround(TICKS_PER_SECOND / static_cast<double>(target_fps));
   // Initialize time points
-  s_last_frame_time = glfwGetTime();
-  s_last_fps_time = s_last_frame_time;
+  s_last_frame_ticks = now();
+  s_last_fps_ticks = s_last_frame_ticks;
 }
 
-void Time::begin_frame() {
-  s_frame_start_time = glfwGetTime();
-  s_delta_time = s_frame_start_time - s_last_frame_time;
-  s_last_frame_time = s_frame_start_time;
+void Time::set_fixed_update(double hz, unsigned int max_steps) {
+  s_fixed_step_ticks = hz > 0.0 ? std::llround(TICKS_PER_SECOND / hz) : 0;
+  s_max_steps = max_steps > 0 ? max_steps : 1;
+  s_accumulator_ticks = 0;
+  s_simulation_ticks = s_total_ticks;
+}
 
-  s_total_time += static_cast<float>(s_delta_time);
+void Time::begin_frame() {
+  s_frame_start_ticks = now();
+  const int64_t frame_ticks = s_fixed_step
+                                  ? s_target_frame_ticks
+                                  : s_frame_start_ticks - s_last_frame_ticks;
+  s_last_frame_ticks = s_frame_start_ticks;
+  s_delta_time = ticks_to_seconds(frame_ticks);
+  s_total_ticks += frame_ticks;
+
+  if (is_fixed_update()) {
+    s_accumulator_ticks += frame_ticks;
+    s_steps_this_frame = 0;
+  }
 
   update_fps();
 }
 
+bool Time::next_fixed_step() {
+  if (!is_fixed_update() || s_accumulator_ticks < s_fixed_step_ticks) {
+    return false;
+  }
+  if (s_steps_this_frame == s_max_steps) {
+    // Catching up would take longer than the frame it catches up on; give
+    // up the whole steps and keep the fraction for interpolation.
+    s_dropped_steps_count +=
+        static_cast<int>(s_accumulator_ticks / s_fixed_step_ticks);
+    s_accumulator_ticks %= s_fixed_step_ticks;
+    return false;
+  }
+  s_accumulator_ticks -= s_fixed_step_ticks;
+  s_simulation_ticks += s_fixed_step_ticks;
+  s_steps_this_frame++;
+  return true;
+}
+
+float Time::get_interpolation_alpha() {
+  if (!is_fixed_update()) {
+    return 1.0f;
+  }
+  return static_cast<float>(static_cast<double>(s_accumulator_ticks) /
+                            static_cast<double>(s_fixed_step_ticks));
+}
+
 void Time::end_frame() {
   // NOTE: This can be removed if perfect accuracy detection is not needed
-  const double tolerance = 0.0001; // 0.1ms
+  const int64_t tolerance = TICKS_PER_SECOND / 10000; // 0.1ms
 
   // Check if the frame's work took too long, including the tolerance.
-  if (glfwGetTime() > s_frame_start_time + s_target_frame_time + tolerance) {
+  if (now() > s_frame_start_ticks + s_target_frame_ticks + tolerance) {
     s_missed_frames_count++;
   }
   // End accuracy detection
 
   // The target time for when the current frame *should* end.
-  const double target_frame_end_time = s_frame_start_time + s_target_frame_time;
+  const int64_t target_frame_end_ticks =
+      s_frame_start_ticks + s_target_frame_ticks;
 
   // A threshold for when to switch from sleeping to busy-waiting.
   // 2ms is a common value. Sleeping for less than this can be inaccurate.
-  const double busy_wait_threshold = 0.002; // 2 milliseconds
+  const int64_t busy_wait_threshold = TICKS_PER_SECOND / 500; // 2 milliseconds
 
   // Calculate how much time we have left in the current frame.
-  double time_to_wait = target_frame_end_time - glfwGetTime();
+  const int64_t ticks_to_wait = target_frame_end_ticks - now();
 
   // If we have more time left than our threshold, we can afford to sleep.
-  if (time_to_wait > busy_wait_threshold) {
+  if (ticks_to_wait > busy_wait_threshold) {
     // We sleep for a duration that is slightly less than what we need,
     // to account for sleep inaccuracies and leave the rest for the busy-wait.
     auto sleep_duration =
-        std::chrono::duration<double>(time_to_wait - busy_wait_threshold);
+        std::chrono::nanoseconds(ticks_to_wait - busy_wait_threshold);
 
     // NOTE: This can be removed if perfect accuracy detection is not needed
-    double time_before_sleep = glfwGetTime();
+    const int64_t ticks_before_sleep = now();
     // End accuracy detection
 
     std::this_thread::sleep_for(sleep_duration);
 
     // NOTE: This can be removed if perfect accuracy detection is not needed
-    double time_after_sleep = glfwGetTime();
-    double actual_sleep_duration = time_after_sleep - time_before_sleep;
-    double over_sleep_amount = actual_sleep_duration - sleep_duration.count();
+    const double over_sleep_amount = ticks_to_seconds(
+        now() - ticks_before_sleep - sleep_duration.count());
 
     if (over_sleep_amount > 0.001) {
       Log::warn("sleep_for over-slept by " + std::to_string(over_sleep_amount));
@@ -81,7 +141,7 @@ void Time::end_frame() {
   // we enter a tight loop to wait for the exact moment our frame should end.
   // This provides high-precision timing without burning the CPU for the entire
   // wait period.
-  while (glfwGetTime() < target_frame_end_time) {
+  while (now() < target_frame_end_ticks) {
     // Busy-wait (spin) until the target time is reached.
     // Log::info("Spinning...");
   }
@@ -90,7 +150,7 @@ void Time::end_frame() {
 void Time::update_fps() {
   s_frame_count++;
   // If one second has passed since the last FPS update
-  if (s_frame_start_time - s_last_fps_time >= 1.0) {
+  if (s_frame_start_ticks - s_last_fps_ticks >= TICKS_PER_SECOND) {
     // Log::debug("FPS: " + std::to_string(s_frame_count));
 
     // NOTE: This can be removed if perfect accuracy detection is not needed
@@ -98,11 +158,16 @@ void Time::update_fps() {
       Log::warn("Missed " + std::to_string(s_missed_frames_count) + " frames.");
     }
     // End accuracy detection
+    if (s_dropped_steps_count > 0) {
+      Log::warn("Dropped " + std::to_string(s_dropped_steps_count) +
+                " fixed update steps.");
+    }
 
     // Reset for the next second
     s_frame_count = 0;
     s_missed_frames_count = 0; // NOTE: This can be removed if perfect accuracy
                                // detection is not needed
-    s_last_fps_time = s_frame_start_time;
+    s_dropped_steps_count = 0;
+    s_last_fps_ticks = s_frame_start_ticks;
   }
 }
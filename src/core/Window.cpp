@@ -7,9 +7,44 @@
 #include <glad/glad.h>
 #include <iostream>
 
+#ifdef HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+struct Window::HeadlessContext {
+#ifdef HAS_EGL
+  EGLDisplay display = EGL_NO_DISPLAY;
+  EGLSurface surface = EGL_NO_SURFACE; // Only if surfaceless is unsupported
+  EGLContext context = EGL_NO_CONTEXT;
+#endif
+};
+
 Window::Window() = default;
 
 Window::~Window() {
+  if (m_headless) {
+    if (m_framebuffer != 0) {
+      glDeleteFramebuffers(1, &m_framebuffer);
+      glDeleteRenderbuffers(1, &m_color_renderbuffer);
+      glDeleteRenderbuffers(1, &m_depth_renderbuffer);
+    }
+#ifdef HAS_EGL
+    if (m_headless->display != EGL_NO_DISPLAY) {
+      eglMakeCurrent(m_headless->display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                     EGL_NO_CONTEXT);
+      if (m_headless->context != EGL_NO_CONTEXT) {
+        eglDestroyContext(m_headless->display, m_headless->context);
+      }
+      if (m_headless->surface != EGL_NO_SURFACE) {
+        eglDestroySurface(m_headless->display, m_headless->surface);
+      }
+      eglTerminate(m_headless->display);
+    }
+#endif
+    std::cout << "Headless context destroyed." << std::endl;
+    return;
+  }
   if (m_window) {
     glfwDestroyWindow(m_window);
   }
@@ -17,23 +52,36 @@ Window::~Window() {
   std::cout << "Window destroyed and GLFW terminated." << std::endl;
 }
 
-static void cursor_position_callback(GLFWwindow *window, double xpos,
-                                     double ypos) {
-  EventDispatcher::queue_event(std::make_unique<MouseMovedEvent>(
-      static_cast<float>(xpos), static_cast<float>(ypos)));
+void Window::cursor_position_callback(GLFWwindow *window, double xpos,
+                                      double ypos) {
+  Window *window_instance =
+      static_cast<Window *>(glfwGetWindowUserPointer(window));
+  double delta_x = 0.0;
+  double delta_y = 0.0;
+  if (window_instance) {
+    // The first move has no previous position to measure from.
+    if (window_instance->m_has_cursor) {
+      delta_x = xpos - window_instance->m_cursor_x;
+      delta_y = ypos - window_instance->m_cursor_y;
+    }
+    window_instance->m_cursor_x = xpos;
+    window_instance->m_cursor_y = ypos;
+    window_instance->m_has_cursor = true;
+  }
+  EventDispatcher::post<MouseMovedEvent>(
+      static_cast<float>(xpos), static_cast<float>(ypos),
+      static_cast<float>(delta_x), static_cast<float>(delta_y));
 }
 
 static void mouse_button_callback(GLFWwindow *window, int button, int action,
                                   int mods) {
   switch (action) {
   case GLFW_PRESS: {
-    EventDispatcher::queue_event(
-        std::make_unique<MouseButtonPressedEvent>(button));
+    EventDispatcher::post<MouseButtonPressedEvent>(button);
     break;
   }
   case GLFW_RELEASE: {
-    EventDispatcher::queue_event(
-        std::make_unique<MouseButtonReleasedEvent>(button));
+    EventDispatcher::post<MouseButtonReleasedEvent>(button);
     break;
   }
   }
@@ -92,24 +140,166 @@ bool Window::init(unsigned int width, unsigned int height, const char *title,
   return true;
 }
 
+bool Window::init_headless(unsigned int width, unsigned int height,
+                           unsigned int max_frames) {
+  m_width = width;
+  m_height = height;
+  m_max_frames = max_frames;
+  m_headless = std::make_unique<HeadlessContext>();
+  // No GLFW window, so no key events; Input just reports nothing pressed.
+  m_input_handler = std::make_unique<Input>(nullptr);
+
+#ifdef HAS_EGL
+  HeadlessContext &egl = *m_headless;
+
+  // 1. Prefer Mesa's surfaceless platform, which needs no display server at
+  // all; fall back to the default display.
+  auto get_platform_display =
+      reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+          eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if (get_platform_display) {
+    egl.display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA,
+                                       EGL_DEFAULT_DISPLAY, nullptr);
+  }
+  if (egl.display == EGL_NO_DISPLAY) {
+    egl.display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  }
+  EGLint major = 0;
+  EGLint minor = 0;
+  if (egl.display == EGL_NO_DISPLAY ||
+      !eglInitialize(egl.display, &major, &minor)) {
+    std::cerr << "Failed to initialize an EGL display" << std::endl;
+    return false;
+  }
+
+  // 2. Desktop OpenGL 4.3 core, the same as the windowed context.
+  const EGLint config_attributes[] = {EGL_SURFACE_TYPE,
+                                      EGL_PBUFFER_BIT,
+                                      EGL_RENDERABLE_TYPE,
+                                      EGL_OPENGL_BIT,
+                                      EGL_NONE};
+  EGLConfig config = nullptr;
+  EGLint config_count = 0;
+  if (!eglBindAPI(EGL_OPENGL_API) ||
+      !eglChooseConfig(egl.display, config_attributes, &config, 1,
+                       &config_count) ||
+      config_count == 0) {
+    std::cerr << "No EGL config supports desktop OpenGL" << std::endl;
+    return false;
+  }
+  const EGLint context_attributes[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                       4,
+                                       EGL_CONTEXT_MINOR_VERSION,
+                                       3,
+                                       EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                       EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                       EGL_NONE};
+  egl.context = eglCreateContext(egl.display, config, EGL_NO_CONTEXT,
+                                 context_attributes);
+  if (egl.context == EGL_NO_CONTEXT) {
+    std::cerr << "Failed to create an OpenGL 4.3 EGL context" << std::endl;
+    return false;
+  }
+
+  // 3. Make it current without a surface if possible (we render into our
+  // own framebuffer anyway), else with a minimal pbuffer.
+  if (!eglMakeCurrent(egl.display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                      egl.context)) {
+    const EGLint pbuffer_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1,
+                                         EGL_NONE};
+    egl.surface =
+        eglCreatePbufferSurface(egl.display, config, pbuffer_attributes);
+    if (egl.surface == EGL_NO_SURFACE ||
+        !eglMakeCurrent(egl.display, egl.surface, egl.surface, egl.context)) {
+      std::cerr << "Failed to make the EGL context current" << std::endl;
+      return false;
+    }
+  }
+
+  // 4. Initialize GLAD
+  if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+    std::cerr << "Failed to initialize GLAD" << std::endl;
+    return false;
+  }
+
+  if (!create_offscreen_framebuffer()) {
+    return false;
+  }
+
+  std::cout << "Headless EGL " << major << "." << minor
+            << " context initialized (" << glGetString(GL_RENDERER) << ")."
+            << std::endl;
+  return true;
+#else
+  std::cerr << "Headless mode needs a build with EGL" << std::endl;
+  return false;
+#endif
+}
+
+bool Window::create_offscreen_framebuffer() {
+  glGenRenderbuffers(1, &m_color_renderbuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, m_color_renderbuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_width, m_height);
+  glGenRenderbuffers(1, &m_depth_renderbuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, m_depth_renderbuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_width,
+                        m_height);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glGenFramebuffers(1, &m_framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, m_color_renderbuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                            GL_RENDERBUFFER, m_depth_renderbuffer);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+    return false;
+  }
+  // Left bound for the whole run: the renderers draw to whatever
+  // framebuffer is bound, so they work unchanged.
+  glViewport(0, 0, m_width, m_height);
+  return true;
+}
+
 Input *Window::get_input() { return m_input_handler.get(); }
 
-bool Window::should_close() { return glfwWindowShouldClose(m_window); }
+bool Window::should_close() {
+  return m_headless ? m_should_close : glfwWindowShouldClose(m_window);
+}
 
 void Window::set_should_close(bool value) {
-  glfwSetWindowShouldClose(m_window, value);
+  if (m_headless) {
+    m_should_close = value;
+  } else {
+    glfwSetWindowShouldClose(m_window, value);
+  }
 }
 
-void Window::swap_buffers() { glfwSwapBuffers(m_window); }
+void Window::swap_buffers() {
+  if (!m_headless) {
+    glfwSwapBuffers(m_window);
+    return;
+  }
+  // Nothing to present; just hand the frame to the driver and count it.
+  glFlush();
+  m_frame_count++;
+  if (m_max_frames != 0 && m_frame_count >= m_max_frames) {
+    m_should_close = true;
+  }
+}
 
-void Window::poll_events() { glfwPollEvents(); }
+void Window::poll_events() {
+  if (!m_headless) {
+    glfwPollEvents();
+  }
+}
 
 // This static function acts as a bridge
 void Window::framebuffer_size_callback(GLFWwindow *window, int width,
                                        int height) {
   // Publish the event
-  EventDispatcher::queue_event(
-      std::make_unique<WindowResizeEvent>(width, height));
+  EventDispatcher::post<WindowResizeEvent>(width, height);
 
   // Retrieve the Window instance that owns this GLFWwindow
   Window *window_instance =
@@ -1,19 +1,23 @@
 #include "core/events/EventDispatcher.h"
-#include <utility>
+#include "utils/Log.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
 
 // --- ScopedSubscription Implementation ---
 ScopedSubscription::ScopedSubscription(SubscriptionHandle handle,
-                                       std::type_index type_index)
-    : m_handle(handle), m_type_index(type_index) {}
+                                       uint32_t event_id)
+    : m_handle(handle), m_event_id(event_id) {}
 
 ScopedSubscription::~ScopedSubscription() {
   if (m_handle != static_cast<SubscriptionHandle>(-1)) {
-    EventDispatcher::unsubscribe(m_handle, m_type_index);
+    EventDispatcher::unsubscribe(m_handle, m_event_id);
   }
 }
 
 ScopedSubscription::ScopedSubscription(ScopedSubscription &&other) noexcept
-    : m_handle(other.m_handle), m_type_index(other.m_type_index) {
+    : m_handle(other.m_handle), m_event_id(other.m_event_id) {
   other.reset(); // The moved-from object no longer owns the subscription
 }
 
@@ -22,11 +26,11 @@ ScopedSubscription::operator=(ScopedSubscription &&other) noexcept {
   if (this != &other) {
     // Unsubscribe from the current subscription if it's valid
     if (m_handle != static_cast<SubscriptionHandle>(-1)) {
-      EventDispatcher::unsubscribe(m_handle, m_type_index);
+      EventDispatcher::unsubscribe(m_handle, m_event_id);
     }
     // Move resources from the other object
     m_handle = other.m_handle;
-    m_type_index = other.m_type_index;
+    m_event_id = other.m_event_id;
     // The moved-from object no longer owns the subscription
     other.reset();
   }
@@ -35,42 +39,186 @@ ScopedSubscription::operator=(ScopedSubscription &&other) noexcept {
 
 void ScopedSubscription::reset() {
   m_handle = -1;
-  m_type_index = typeid(void);
+  m_event_id = 0;
 }
 
 // --- EventDispatcher Implementation ---
-std::unordered_map<
-    std::type_index,
-    std::map<EventDispatcher::SubscriptionHandle, std::function<void(Event &)>>>
-    EventDispatcher::s_subscribers;
+std::vector<EventDispatcher::SubscriberTable> EventDispatcher::s_tables;
+std::vector<EventDispatcher::PendingSubscriber> EventDispatcher::s_pending;
+unsigned int EventDispatcher::s_dispatch_depth = 0;
+EventDispatcher::SubscriptionHandle EventDispatcher::s_next_handle = 0;
+EventDispatcher::Hook EventDispatcher::s_hook;
 
-std::vector<std::unique_ptr<Event>> EventDispatcher::s_event_queue;
+EventQueue EventDispatcher::s_event_queue;
+std::vector<Event *> EventDispatcher::s_batch;
+std::vector<Event *> EventDispatcher::s_latest;
+
+EventDispatcher::SubscriberTable *
+EventDispatcher::find_table(uint32_t event_id) {
+  auto it = std::lower_bound(
+      s_tables.begin(), s_tables.end(), event_id,
+      [](const SubscriberTable &table, uint32_t id) {
+        return table.event_id < id;
+      });
+  return it != s_tables.end() && it->event_id == event_id ? &*it : nullptr;
+}
+
+void EventDispatcher::add_subscriber(uint32_t event_id,
+                                     const char *event_name,
+                                     SubscriptionHandle handle,
+                                     Callback callback) {
+  // Growing a table (or the table list) would move delegates that may be
+  // running right now.
+  if (s_dispatch_depth > 0) {
+    s_pending.push_back(
+        PendingSubscriber{event_id, event_name, handle, std::move(callback)});
+    return;
+  }
+
+  SubscriberTable *table = find_table(event_id);
+  if (!table) {
+    auto it = std::lower_bound(
+        s_tables.begin(), s_tables.end(), event_id,
+        [](const SubscriberTable &table, uint32_t id) {
+          return table.event_id < id;
+        });
+    it = s_tables.insert(it, SubscriberTable{});
+    it->event_id = event_id;
+    it->event_name = event_name;
+    table = &*it;
+  } else if (std::strcmp(table->event_name, event_name) != 0) {
+    Log::error(std::string("EventDispatcher: event types ") +
+               table->event_name + " and " + event_name +
+               " hash to the same id; rename one.");
+    std::abort();
+  }
+  table->callbacks.push_back(std::move(callback));
+  table->handles.push_back(handle);
+}
 
-// Private unsubscribe implementation
 void EventDispatcher::unsubscribe(SubscriptionHandle handle,
-                                  std::type_index type_index) {
-  if (s_subscribers.count(type_index)) {
-    s_subscribers.at(type_index).erase(handle);
+                                  uint32_t event_id) {
+  for (auto it = s_pending.begin(); it != s_pending.end(); ++it) {
+    if (it->handle == handle) {
+      s_pending.erase(it);
+      return;
+    }
+  }
+
+  SubscriberTable *table = find_table(event_id);
+  if (!table) {
+    return;
+  }
+  auto it = std::find(table->handles.begin(), table->handles.end(), handle);
+  if (it == table->handles.end()) {
+    return;
+  }
+  const size_t index = static_cast<size_t>(it - table->handles.begin());
+  if (s_dispatch_depth > 0) {
+    // The delegate may be the one running; destroy it after the dispatch.
+    table->handles[index] = INVALID_HANDLE;
+    table->has_holes = true;
+    return;
+  }
+  table->handles.erase(it);
+  table->callbacks.erase(table->callbacks.begin() +
+                         static_cast<std::ptrdiff_t>(index));
+}
+
+void EventDispatcher::apply_pending() {
+  for (SubscriberTable &table : s_tables) {
+    if (!table.has_holes) {
+      continue;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < table.handles.size(); ++i) {
+      if (table.handles[i] != INVALID_HANDLE) {
+        if (kept != i) {
+          table.handles[kept] = table.handles[i];
+          table.callbacks[kept] = std::move(table.callbacks[i]);
+        }
+        kept++;
+      }
+    }
+    table.handles.resize(kept);
+    table.callbacks.resize(kept);
+    table.has_holes = false;
+  }
+
+  auto pending = std::move(s_pending);
+  s_pending.clear();
+  for (PendingSubscriber &subscriber : pending) {
+    add_subscriber(subscriber.event_id, subscriber.event_name,
+                   subscriber.handle, std::move(subscriber.callback));
   }
 }
 
-void EventDispatcher::queue_event(std::unique_ptr<Event> event) {
-  s_event_queue.push_back(std::move(event));
+void EventDispatcher::dispatch(Event &event) {
+  s_dispatch_depth++;
+  if (SubscriberTable *table = find_table(event.get_type_id())) {
+    // Subscribers added meanwhile are deferred, so the size is fixed.
+    const size_t count = table->callbacks.size();
+    for (size_t i = 0; i < count; ++i) {
+      if (table->handles[i] == INVALID_HANDLE) {
+        continue;
+      }
+      table->callbacks[i](event);
+      if (event.handled) {
+        break;
+      }
+    }
+  }
+  if (--s_dispatch_depth == 0) {
+    apply_pending();
+  }
+}
+
+void EventDispatcher::coalesce(std::vector<Event *> &batch) {
+  // Walk newest to oldest, so the first event seen of each type is the one
+  // that survives. A KeepAll event ends the run: folding an event across it
+  // would reorder the two (a move before a click must stay before it). A run
+  // holds only a handful of coalescing types, so a linear search beats a map.
+  s_latest.clear();
+  for (size_t i = batch.size(); i-- > 0;) {
+    Event *event = batch[i];
+    const EventCoalescing policy = event->get_coalescing();
+    if (policy == EventCoalescing::KeepAll) {
+      s_latest.clear();
+      continue;
+    }
+    const uint32_t id = event->get_type_id();
+    auto it = std::find_if(s_latest.begin(), s_latest.end(),
+                           [id](Event *latest) {
+                             return latest->get_type_id() == id;
+                           });
+    if (it == s_latest.end()) {
+      s_latest.push_back(event);
+      continue;
+    }
+    if (policy == EventCoalescing::AccumulateDelta) {
+      (*it)->accumulate(*event);
+    }
+    batch[i] = nullptr;
+  }
 }
 
 void EventDispatcher::dispatch_events() {
-  auto events_to_dispatch = std::move(s_event_queue);
-  s_event_queue.clear();
-  for (const auto &event_ptr : events_to_dispatch) {
-    Event &event = *event_ptr;
-    std::type_index type_index(typeid(event));
-    if (s_subscribers.count(type_index)) {
-      for (auto const &[handle, callback] : s_subscribers.at(type_index)) {
-        callback(event);
-        if (event.handled) {
-          break;
-        }
+  const size_t dropped = s_event_queue.take_dropped_count();
+  if (dropped > 0) {
+    Log::warn("EventDispatcher: queue full, dropped " +
+              std::to_string(dropped) + " events.");
+  }
+  // One pending pass for the whole batch instead of one per event.
+  s_dispatch_depth++;
+  s_event_queue.consume_batch(s_batch, [](std::vector<Event *> &batch) {
+    coalesce(batch);
+    for (Event *event : batch) {
+      if (event && (!s_hook || s_hook(*event))) {
+        dispatch(*event);
       }
     }
+  });
+  if (--s_dispatch_depth == 0) {
+    apply_pending();
   }
 }
@@ -0,0 +1,43 @@
+#include "core/events/EventQueue.h"
+
+EventQueue::EventQueue() : m_slots(new Slot[CAPACITY]) {
+  for (size_t i = 0; i < CAPACITY; ++i) {
+    m_slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+EventQueue::~EventQueue() {
+  // Destroy whatever was never dispatched.
+  consume([](Event &) {});
+}
+
+EventQueue::Slot *EventQueue::claim(size_t &pos) {
+  pos = m_enqueue_pos.load(std::memory_order_relaxed);
+  for (;;) {
+    Slot &slot = m_slots[pos & MASK];
+    const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    const intptr_t lap = static_cast<intptr_t>(sequence) -
+                         static_cast<intptr_t>(pos);
+    if (lap == 0) {
+      // Free for this position; race other producers for it.
+      if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+        return &slot;
+      }
+    } else if (lap < 0) {
+      // Still holds the event from one lap ago: the queue is full.
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    } else {
+      // Another producer took this position; retry from the current one.
+      pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void EventQueue::release(Slot &slot) {
+  slot.event->~Event();
+  slot.event = nullptr;
+  slot.sequence.store(m_dequeue_pos + CAPACITY, std::memory_order_release);
+  m_dequeue_pos++;
+}
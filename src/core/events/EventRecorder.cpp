@@ -0,0 +1,293 @@
+#include "core/events/EventRecorder.h"
+#include "core/events/AppEvent.h"
+#include "core/events/EventDispatcher.h"
+#include "core/events/KeyEvent.h"
+#include "core/events/MouseEvent.h"
+#include "utils/Log.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+
+namespace {
+// Fields are copied in host byte order; logs move between little-endian
+// machines only.
+template <typename T> void put(unsigned char *&out, T value) {
+  std::memcpy(out, &value, sizeof(T));
+  out += sizeof(T);
+}
+
+template <typename T> T get(const unsigned char *&in) {
+  T value;
+  std::memcpy(&value, in, sizeof(T));
+  in += sizeof(T);
+  return value;
+}
+
+template <typename T> void write_key(const Event &event, unsigned char *out) {
+  put(out, static_cast<const T &>(event).get_key_code());
+}
+
+template <typename T> void replay_key(const unsigned char *in) {
+  T event(get<int>(in));
+  EventDispatcher::dispatch(event);
+}
+
+template <typename T>
+void write_button(const Event &event, unsigned char *out) {
+  put(out, static_cast<const T &>(event).get_mouse_button());
+}
+
+template <typename T> void replay_button(const unsigned char *in) {
+  T event(get<int>(in));
+  EventDispatcher::dispatch(event);
+}
+
+void write_moved(const Event &event, unsigned char *out) {
+  const auto &moved = static_cast<const MouseMovedEvent &>(event);
+  put(out, moved.get_x());
+  put(out, moved.get_y());
+  put(out, moved.get_delta_x());
+  put(out, moved.get_delta_y());
+}
+
+void replay_moved(const unsigned char *in) {
+  const float x = get<float>(in);
+  const float y = get<float>(in);
+  const float delta_x = get<float>(in);
+  const float delta_y = get<float>(in);
+  MouseMovedEvent event(x, y, delta_x, delta_y);
+  EventDispatcher::dispatch(event);
+}
+
+void write_resize(const Event &event, unsigned char *out) {
+  const auto &resize = static_cast<const WindowResizeEvent &>(event);
+  put(out, resize.get_width());
+  put(out, resize.get_height());
+}
+
+void replay_resize(const unsigned char *in) {
+  const unsigned int width = get<unsigned int>(in);
+  const unsigned int height = get<unsigned int>(in);
+  WindowResizeEvent event(width, height);
+  EventDispatcher::dispatch(event);
+}
+
+// How each recordable event type is stored and rebuilt.
+struct EventCodec {
+  uint32_t type_id;
+  size_t size; // Bytes of fields
+  void (*write)(const Event &event, unsigned char *out);
+  void (*replay)(const unsigned char *in);
+};
+
+const EventCodec CODECS[] = {
+    {KeyPressedEvent::STATIC_TYPE_ID, sizeof(int), write_key<KeyPressedEvent>,
+     replay_key<KeyPressedEvent>},
+    {KeyReleasedEvent::STATIC_TYPE_ID, sizeof(int),
+     write_key<KeyReleasedEvent>, replay_key<KeyReleasedEvent>},
+    {MouseButtonPressedEvent::STATIC_TYPE_ID, sizeof(int),
+     write_button<MouseButtonPressedEvent>,
+     replay_button<MouseButtonPressedEvent>},
+    {MouseButtonReleasedEvent::STATIC_TYPE_ID, sizeof(int),
+     write_button<MouseButtonReleasedEvent>,
+     replay_button<MouseButtonReleasedEvent>},
+    {MouseMovedEvent::STATIC_TYPE_ID, 4 * sizeof(float), write_moved,
+     replay_moved},
+    {WindowResizeEvent::STATIC_TYPE_ID, 2 * sizeof(unsigned int),
+     write_resize, replay_resize},
+};
+
+const EventCodec *find_codec(uint32_t type_id) {
+  for (const EventCodec &codec : CODECS) {
+    if (codec.type_id == type_id) {
+      return &codec;
+    }
+  }
+  return nullptr;
+}
+
+void write_varint(std::vector<unsigned char> &out, uint32_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<unsigned char>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<unsigned char>(value));
+}
+
+// Returns false if the log ends inside the varint.
+bool read_varint(const std::vector<unsigned char> &in, size_t &pos,
+                 uint32_t &value) {
+  value = 0;
+  for (unsigned int shift = 0; shift < 35 && pos < in.size(); shift += 7) {
+    const unsigned char byte = in[pos++];
+    value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Walks every record, checking it is complete and of a known type. Returns
+// the frame count the records span.
+bool validate(const std::vector<unsigned char> &log, uint32_t &frame_count) {
+  size_t pos = 0;
+  uint32_t frame = 0;
+  frame_count = 0;
+  while (pos < log.size()) {
+    uint32_t delta;
+    if (!read_varint(log, pos, delta) || log.size() - pos < sizeof(uint32_t)) {
+      return false;
+    }
+    const unsigned char *in = log.data() + pos;
+    const EventCodec *codec = find_codec(get<uint32_t>(in));
+    pos += sizeof(uint32_t);
+    if (!codec || log.size() - pos < codec->size) {
+      return false;
+    }
+    pos += codec->size;
+    frame += delta;
+    frame_count = frame + 1;
+  }
+  return true;
+}
+} // namespace
+
+EventRecorder::~EventRecorder() { stop(); }
+
+bool EventRecorder::start_recording(const std::string &path, float fps) {
+  stop();
+  m_file.open(path, std::ios::binary | std::ios::trunc);
+  if (!m_file) {
+    Log::error("EventRecorder: cannot write '" + path + "'.");
+    return false;
+  }
+  Header header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.fps = fps;
+  m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  m_mode = Mode::Recording;
+  m_frame = 0;
+  m_last_record_frame = 0;
+  m_buffer.clear();
+  EventDispatcher::set_hook([this](const Event &event) {
+    record(event);
+    return true;
+  });
+  Log::info("EventRecorder: recording input to " + path + ".");
+  return true;
+}
+
+bool EventRecorder::start_replay(const std::string &path, float &fps) {
+  stop();
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    Log::error("EventRecorder: cannot read '" + path + "'.");
+    return false;
+  }
+  std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)),
+                                  std::istreambuf_iterator<char>());
+  Header header;
+  if (data.size() < sizeof(header)) {
+    Log::error("EventRecorder: '" + path + "' is not an input log.");
+    return false;
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header.version != VERSION) {
+    Log::error("EventRecorder: '" + path +
+               "' is not an input log of version " + std::to_string(VERSION) +
+               ".");
+    return false;
+  }
+  m_log.assign(data.begin() + sizeof(header), data.end());
+  uint32_t record_frames;
+  if (!validate(m_log, record_frames)) {
+    Log::error("EventRecorder: '" + path + "' is truncated or corrupt.");
+    m_log.clear();
+    return false;
+  }
+  // A recording that never stopped cleanly has no frame count.
+  m_frame_count = std::max(header.frame_count, record_frames);
+  fps = header.fps;
+
+  m_mode = Mode::Replaying;
+  m_frame = 0;
+  m_read_pos = 0;
+  m_next_frame = 0;
+  read_next_frame();
+  // Live input would diverge from the recording; only replayed events go
+  // through.
+  EventDispatcher::set_hook(
+      [](const Event &event) { return !find_codec(event.get_type_id()); });
+  Log::info("EventRecorder: replaying " + std::to_string(m_frame_count) +
+            " frames of input from " + path + ".");
+  return true;
+}
+
+void EventRecorder::stop() {
+  if (m_mode == Mode::Idle) {
+    return;
+  }
+  EventDispatcher::set_hook({});
+  if (m_mode == Mode::Recording) {
+    flush();
+    m_file.seekp(offsetof(Header, frame_count));
+    m_file.write(reinterpret_cast<const char *>(&m_frame), sizeof(m_frame));
+    m_file.close();
+    Log::info("EventRecorder: recorded " + std::to_string(m_frame) +
+              " frames.");
+  } else {
+    m_log.clear();
+    m_log.shrink_to_fit();
+  }
+  m_mode = Mode::Idle;
+}
+
+void EventRecorder::end_dispatch() {
+  if (m_mode == Mode::Replaying) {
+    while (m_has_next && m_next_frame <= m_frame) {
+      const unsigned char *in = m_log.data() + m_read_pos;
+      // validate() vouched for the type and size.
+      const EventCodec *codec = find_codec(get<uint32_t>(in));
+      codec->replay(in);
+      m_read_pos += sizeof(uint32_t) + codec->size;
+      read_next_frame();
+    }
+  }
+  if (m_mode != Mode::Idle) {
+    m_frame++;
+  }
+}
+
+void EventRecorder::record(const Event &event) {
+  const EventCodec *codec = find_codec(event.get_type_id());
+  if (!codec) {
+    return;
+  }
+  write_varint(m_buffer, m_frame - m_last_record_frame);
+  m_last_record_frame = m_frame;
+  const size_t offset = m_buffer.size();
+  m_buffer.resize(offset + sizeof(uint32_t) + codec->size);
+  unsigned char *out = m_buffer.data() + offset;
+  put(out, codec->type_id);
+  codec->write(event, out);
+  if (m_buffer.size() >= FLUSH_SIZE) {
+    flush();
+  }
+}
+
+void EventRecorder::flush() {
+  m_file.write(reinterpret_cast<const char *>(m_buffer.data()),
+               static_cast<std::streamsize>(m_buffer.size()));
+  m_buffer.clear();
+}
+
+void EventRecorder::read_next_frame() {
+  uint32_t delta;
+  m_has_next = read_varint(m_log, m_read_pos, delta);
+  m_next_frame += delta;
+}
@@ -0,0 +1,326 @@
+#include "graphics/FrameCapture.h"
+#include "utils/ImageWriter.h"
+#include "utils/Log.h"
+#include <glad/glad.h>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+// How long one glClientWaitSync call blocks before we check again.
+constexpr GLuint64 FENCE_WAIT_NS = 1000000; // 1 ms
+
+const char *extension_of(CaptureFormat format) {
+  switch (format) {
+  case CaptureFormat::Png:
+    return ".png";
+  case CaptureFormat::Raw:
+    return ".rgba";
+  case CaptureFormat::Y4m:
+    return ".y4m";
+  }
+  return "";
+}
+} // namespace
+
+FrameCapture::FrameCapture() {
+  // Started here rather than in the initializer list so every member the
+  // thread touches already exists.
+  m_worker = std::thread(&FrameCapture::worker_loop, this);
+}
+
+FrameCapture::~FrameCapture() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_quit = true;
+  }
+  m_job_ready.notify_one();
+  m_worker.join();
+}
+
+bool FrameCapture::parse_format(const std::string &name,
+                                CaptureFormat &format) {
+  if (name == "png") {
+    format = CaptureFormat::Png;
+  } else if (name == "raw") {
+    format = CaptureFormat::Raw;
+  } else if (name == "y4m") {
+    format = CaptureFormat::Y4m;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool FrameCapture::start(unsigned int frame_count, CaptureFormat format,
+                         const std::string &path, unsigned int fps) {
+  if (m_session_open) {
+    Log::warn("FrameCapture: a capture is already running.");
+    return false;
+  }
+  if (path.empty()) {
+    Log::warn("FrameCapture: no output path given.");
+    return false;
+  }
+  m_session_open = true;
+  m_reading = true;
+  m_frames_requested = frame_count;
+  m_frames_issued = 0;
+  m_format = format;
+  m_path = path;
+  m_fps = fps > 0 ? fps : 60;
+  m_stream_width = 0;
+  m_stream_height = 0;
+  Log::info("FrameCapture: capturing " +
+            (frame_count > 0 ? std::to_string(frame_count) : "all") +
+            " frames to " + path + extension_of(format));
+  return true;
+}
+
+void FrameCapture::stop() {
+  if (!m_session_open) {
+    return;
+  }
+  m_reading = false;
+  collect(true);
+  finish_session();
+}
+
+void FrameCapture::capture(unsigned int framebuffer, unsigned int width,
+                           unsigned int height) {
+  collect(false);
+
+  if (m_reading && width > 0 && height > 0) {
+    if (m_format != CaptureFormat::Png && m_stream_width != 0 &&
+        (width != m_stream_width || height != m_stream_height)) {
+      // Raw and Y4M streams have one frame size.
+      Log::warn("FrameCapture: frame size changed; stopping the capture.");
+      m_reading = false;
+    } else {
+      m_stream_width = width;
+      m_stream_height = height;
+
+      // The ring is full: wait for the oldest readback.
+      Slot &slot = m_slots[m_next_slot];
+      if (slot.pending) {
+        read_slot(slot);
+      }
+      const size_t size = size_t(width) * height * 4;
+      if (slot.buffer == 0) {
+        glGenBuffers(1, &slot.buffer);
+      }
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+      if (slot.capacity < size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size),
+                     nullptr, GL_STREAM_READ);
+        slot.capacity = size;
+      }
+      glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+      glReadBuffer(framebuffer == 0 ? GL_BACK : GL_COLOR_ATTACHMENT0);
+      glPixelStorei(GL_PACK_ALIGNMENT, 1);
+      // With a pack buffer bound this only queues the copy.
+      glReadPixels(0, 0, static_cast<GLsizei>(width),
+                   static_cast<GLsizei>(height), GL_RGBA, GL_UNSIGNED_BYTE,
+                   nullptr);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+      slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      slot.width = width;
+      slot.height = height;
+      slot.frame = m_frames_issued++;
+      slot.pending = true;
+      m_next_slot = (m_next_slot + 1) % RING_SIZE;
+
+      if (m_frames_requested != 0 && m_frames_issued >= m_frames_requested) {
+        m_reading = false;
+      }
+    }
+  }
+
+  // Once the last readback has gone to the encoder, close the session.
+  if (m_session_open && !m_reading) {
+    bool any_pending = false;
+    for (const Slot &slot : m_slots) {
+      any_pending |= slot.pending;
+    }
+    if (!any_pending) {
+      finish_session();
+    }
+  }
+}
+
+void FrameCapture::shutdown() {
+  stop();
+  for (Slot &slot : m_slots) {
+    if (slot.buffer != 0) {
+      glDeleteBuffers(1, &slot.buffer);
+    }
+    slot = Slot{};
+  }
+}
+
+void FrameCapture::collect(bool wait) {
+  // Slots are filled in ring order, so the oldest pending one follows the
+  // slot written last.
+  for (unsigned int i = 0; i < RING_SIZE; ++i) {
+    Slot &slot = m_slots[(m_next_slot + i) % RING_SIZE];
+    if (!slot.pending) {
+      continue;
+    }
+    if (!wait) {
+      const GLenum status =
+          glClientWaitSync(static_cast<GLsync>(slot.fence), 0, 0);
+      if (status != GL_ALREADY_SIGNALED &&
+          status != GL_CONDITION_SATISFIED) {
+        break;
+      }
+    }
+    read_slot(slot);
+  }
+}
+
+void FrameCapture::read_slot(Slot &slot) {
+  // Flush on the first wait so the fence is guaranteed to reach the GPU.
+  GLsync fence = static_cast<GLsync>(slot.fence);
+  GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+  for (;;) {
+    const GLenum result = glClientWaitSync(fence, flags, FENCE_WAIT_NS);
+    if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED ||
+        result == GL_WAIT_FAILED) {
+      break;
+    }
+    flags = 0;
+  }
+  glDeleteSync(fence);
+  slot.fence = nullptr;
+  slot.pending = false;
+
+  Job job;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_spare_pixels.empty()) {
+      job.pixels = std::move(m_spare_pixels.back());
+      m_spare_pixels.pop_back();
+    }
+  }
+  const size_t row_bytes = size_t(slot.width) * 4;
+  job.pixels.resize(row_bytes * slot.height);
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  const auto *mapped = static_cast<const unsigned char *>(
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                       static_cast<GLsizeiptr>(job.pixels.size()),
+                       GL_MAP_READ_BIT));
+  if (mapped) {
+    // GL rows run bottom-up; flip while copying out.
+    for (unsigned int y = 0; y < slot.height; ++y) {
+      std::memcpy(job.pixels.data() + y * row_bytes,
+                  mapped + (slot.height - 1 - y) * row_bytes, row_bytes);
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (!mapped) {
+    Log::error("FrameCapture: failed to map frame " +
+               std::to_string(slot.frame) + ".");
+    return;
+  }
+
+  job.width = slot.width;
+  job.height = slot.height;
+  job.frame = slot.frame;
+  job.format = m_format;
+  job.path = m_path;
+  job.fps = m_fps;
+  push_job(std::move(job));
+}
+
+void FrameCapture::finish_session() {
+  Job job;
+  job.finish = true;
+  job.format = m_format;
+  job.path = m_path;
+  push_job(std::move(job));
+  m_session_open = false;
+  m_reading = false;
+}
+
+void FrameCapture::push_job(Job job) {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_job_taken.wait(lock,
+                     [this] { return m_jobs.size() < MAX_QUEUED_FRAMES; });
+    m_jobs.push_back(std::move(job));
+  }
+  m_job_ready.notify_one();
+}
+
+void FrameCapture::worker_loop() {
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_job_ready.wait(lock, [this] { return m_quit || !m_jobs.empty(); });
+      // Drain the queue before quitting so no captured frame is lost.
+      if (m_jobs.empty()) {
+        return;
+      }
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+    m_job_taken.notify_one();
+
+    encode(job);
+
+    if (!job.pixels.empty()) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_spare_pixels.push_back(std::move(job.pixels));
+    }
+  }
+}
+
+void FrameCapture::encode(Job &job) {
+  if (job.finish) {
+    if (m_stream.is_open()) {
+      m_stream.close();
+    }
+    Log::info("FrameCapture: wrote " + std::to_string(m_frames_written) +
+              " frames to " + job.path + extension_of(job.format));
+    m_frames_written = 0;
+    return;
+  }
+
+  if (job.format == CaptureFormat::Png) {
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_%05u", job.frame);
+    const std::string file = job.path + suffix + ".png";
+    if (!ImageWriter::write_png(file, job.width, job.height,
+                                job.pixels.data())) {
+      Log::error("FrameCapture: failed to write " + file);
+      return;
+    }
+  } else {
+    if (!m_stream.is_open()) {
+      const std::string file = job.path + extension_of(job.format);
+      m_stream.open(file, std::ios::binary | std::ios::trunc);
+      if (!m_stream) {
+        Log::error("FrameCapture: failed to open " + file);
+        return;
+      }
+      if (job.format == CaptureFormat::Y4m) {
+        ImageWriter::write_y4m_header(m_stream, job.width, job.height,
+                                      job.fps);
+      } else {
+        Log::info("FrameCapture: " + file + " holds " +
+                  std::to_string(job.width) + "x" +
+                  std::to_string(job.height) + " RGBA8 frames.");
+      }
+    }
+    if (job.format == CaptureFormat::Y4m) {
+      ImageWriter::write_y4m_frame(m_stream, job.width, job.height,
+                                   job.pixels.data());
+    } else {
+      m_stream.write(reinterpret_cast<const char *>(job.pixels.data()),
+                     static_cast<std::streamsize>(job.pixels.size()));
+    }
+  }
+  m_frames_written++;
+}
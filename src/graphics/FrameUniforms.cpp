@@ -0,0 +1,64 @@
+#include "graphics/FrameUniforms.h"
+#include <cstddef>
+#include <glad/glad.h>
+
+// std140: mat4 is four vec4 columns, and the vec2 and floats pack into the
+// 16 bytes after the matrices.
+static_assert(offsetof(FrameUniforms::Data, view) == 0, "std140 mismatch");
+static_assert(offsetof(FrameUniforms::Data, projection) == 64,
+              "std140 mismatch");
+static_assert(offsetof(FrameUniforms::Data, view_projection) == 128,
+              "std140 mismatch");
+static_assert(offsetof(FrameUniforms::Data, resolution) == 192,
+              "std140 mismatch");
+static_assert(offsetof(FrameUniforms::Data, time) == 200, "std140 mismatch");
+static_assert(offsetof(FrameUniforms::Data, delta_time) == 204,
+              "std140 mismatch");
+static_assert(sizeof(FrameUniforms::Data) == 208, "std140 mismatch");
+
+FrameUniforms::Data FrameUniforms::s_data;
+unsigned int FrameUniforms::s_buffer = 0;
+
+void FrameUniforms::init() {
+  if (s_buffer != 0) {
+    return;
+  }
+  glGenBuffers(1, &s_buffer);
+  glBindBuffer(GL_UNIFORM_BUFFER, s_buffer);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(Data), &s_data, GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  // The binding point never changes, so bind once for the whole run.
+  glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, s_buffer);
+}
+
+void FrameUniforms::shutdown() {
+  if (s_buffer != 0) {
+    glDeleteBuffers(1, &s_buffer);
+    s_buffer = 0;
+  }
+}
+
+void FrameUniforms::begin_frame(float time, float delta_time,
+                                unsigned int width, unsigned int height) {
+  s_data.resolution = glm::vec2(static_cast<float>(width),
+                                static_cast<float>(height));
+  s_data.time = time;
+  s_data.delta_time = delta_time;
+
+  glBindBuffer(GL_UNIFORM_BUFFER, s_buffer);
+  glBufferSubData(GL_UNIFORM_BUFFER, offsetof(Data, resolution),
+                  sizeof(Data) - offsetof(Data, resolution),
+                  &s_data.resolution);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameUniforms::set_camera(const glm::mat4 &view,
+                               const glm::mat4 &projection) {
+  s_data.view = view;
+  s_data.projection = projection;
+  s_data.view_projection = projection * view;
+
+  glBindBuffer(GL_UNIFORM_BUFFER, s_buffer);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, offsetof(Data, resolution), &s_data);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,89 @@
+#include "graphics/Frustum.h"
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#define FRUSTUM_USE_SSE 1
+#endif
+
+Frustum Frustum::from_matrix(const glm::mat4 &m) {
+  // Gribb/Hartmann: each plane is the fourth row of the matrix plus or minus
+  // one of the other rows. glm is column-major, so row r is (m[0][r], ...).
+  auto row = [&m](int r) {
+    return glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+  };
+  Frustum frustum;
+  frustum.planes[PLANE_LEFT] = row(3) + row(0);
+  frustum.planes[PLANE_RIGHT] = row(3) - row(0);
+  frustum.planes[PLANE_BOTTOM] = row(3) + row(1);
+  frustum.planes[PLANE_TOP] = row(3) - row(1);
+  frustum.planes[PLANE_NEAR] = row(3) + row(2);
+  frustum.planes[PLANE_FAR] = row(3) - row(2);
+  // Normalize so the plane distance is in world units, comparable to radii.
+  for (glm::vec4 &plane : frustum.planes) {
+    plane /= glm::length(glm::vec3(plane));
+  }
+  return frustum;
+}
+
+Frustum::Containment Frustum::test(const Aabb &box) const {
+  Containment result = INSIDE;
+  for (const glm::vec4 &plane : planes) {
+    // The corners furthest along and against the plane normal.
+    const glm::vec3 positive(plane.x >= 0.0f ? box.max.x : box.min.x,
+                             plane.y >= 0.0f ? box.max.y : box.min.y,
+                             plane.z >= 0.0f ? box.max.z : box.min.z);
+    const glm::vec3 negative(plane.x >= 0.0f ? box.min.x : box.max.x,
+                             plane.y >= 0.0f ? box.min.y : box.max.y,
+                             plane.z >= 0.0f ? box.min.z : box.max.z);
+    const glm::vec3 normal(plane);
+    if (glm::dot(normal, positive) + plane.w < 0.0f) {
+      return OUTSIDE;
+    }
+    if (glm::dot(normal, negative) + plane.w < 0.0f) {
+      result = INTERSECTING;
+    }
+  }
+  return result;
+}
+
+void Frustum::cull_spheres(const BoundingSphere *spheres, size_t count,
+                           uint8_t *visible) const {
+  size_t i = 0;
+#ifdef FRUSTUM_USE_SSE
+  // Transpose four spheres into x/y/z/r registers, then test all four
+  // against one plane per step: outside if dot(n, c) + d < -r.
+  for (; i + 4 <= count; i += 4) {
+    __m128 x = _mm_loadu_ps(&spheres[i].x);
+    __m128 y = _mm_loadu_ps(&spheres[i + 1].x);
+    __m128 z = _mm_loadu_ps(&spheres[i + 2].x);
+    __m128 r = _mm_loadu_ps(&spheres[i + 3].x);
+    _MM_TRANSPOSE4_PS(x, y, z, r);
+    const __m128 neg_r = _mm_sub_ps(_mm_setzero_ps(), r);
+
+    __m128 outside = _mm_setzero_ps();
+    for (const glm::vec4 &plane : planes) {
+      __m128 dist = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)),
+                     _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+          _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)),
+                     _mm_set1_ps(plane.w)));
+      outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, neg_r));
+    }
+
+    const int mask = _mm_movemask_ps(outside);
+    visible[i] = !(mask & 1);
+    visible[i + 1] = !(mask & 2);
+    visible[i + 2] = !(mask & 4);
+    visible[i + 3] = !(mask & 8);
+  }
+#endif
+  // Scalar tail (and fallback without SSE).
+  for (; i < count; ++i) {
+    const glm::vec3 center(spheres[i]);
+    bool inside = true;
+    for (const glm::vec4 &plane : planes) {
+      inside &= glm::dot(glm::vec3(plane), center) + plane.w >= -spheres[i].w;
+    }
+    visible[i] = inside;
+  }
+}
@@ -0,0 +1,79 @@
+#include "graphics/GLState.h"
+#include <glad/glad.h>
+
+namespace {
+// No real object has this name, so it never matches a requested binding.
+constexpr unsigned int UNKNOWN = ~0u;
+} // namespace
+
+unsigned int GLState::s_program = UNKNOWN;
+unsigned int GLState::s_vertex_array = UNKNOWN;
+unsigned int GLState::s_active_unit = UNKNOWN;
+unsigned int GLState::s_textures[GLState::MAX_TEXTURE_UNITS] = {
+    UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN,
+    UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN};
+
+void GLState::use_program(unsigned int program) {
+  if (s_program != program) {
+    glUseProgram(program);
+    s_program = program;
+  }
+}
+
+void GLState::bind_vertex_array(unsigned int vertex_array) {
+  if (s_vertex_array != vertex_array) {
+    glBindVertexArray(vertex_array);
+    s_vertex_array = vertex_array;
+  }
+}
+
+void GLState::bind_texture(unsigned int unit, unsigned int texture) {
+  if (unit >= MAX_TEXTURE_UNITS) {
+    // Untracked unit: bind directly and forget what the active unit is.
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    s_active_unit = UNKNOWN;
+    return;
+  }
+  if (s_textures[unit] == texture) {
+    return;
+  }
+  if (s_active_unit != unit) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    s_active_unit = unit;
+  }
+  glBindTexture(GL_TEXTURE_2D, texture);
+  s_textures[unit] = texture;
+}
+
+void GLState::delete_program(unsigned int program) {
+  glDeleteProgram(program);
+  if (s_program == program) {
+    s_program = UNKNOWN;
+  }
+}
+
+void GLState::delete_vertex_array(unsigned int vertex_array) {
+  glDeleteVertexArrays(1, &vertex_array);
+  if (s_vertex_array == vertex_array) {
+    s_vertex_array = UNKNOWN;
+  }
+}
+
+void GLState::delete_texture(unsigned int texture) {
+  glDeleteTextures(1, &texture);
+  for (unsigned int &bound : s_textures) {
+    if (bound == texture) {
+      bound = UNKNOWN;
+    }
+  }
+}
+
+void GLState::invalidate() {
+  s_program = UNKNOWN;
+  s_vertex_array = UNKNOWN;
+  s_active_unit = UNKNOWN;
+  for (unsigned int &bound : s_textures) {
+    bound = UNKNOWN;
+  }
+}
@@ -0,0 +1,262 @@
+#include "graphics/GeometryArena.h"
+#include "graphics/GLState.h"
+#include "graphics/Mesh.h"
+#include "utils/Log.h"
+#include <algorithm>
+#include <cstddef>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <iterator>
+#include <string>
+
+unsigned int GeometryArena::s_vao = 0;
+unsigned int GeometryArena::s_vbo = 0;
+unsigned int GeometryArena::s_ebo = 0;
+unsigned int GeometryArena::s_identity_instance = 0;
+GeometryArena::RangeAllocator GeometryArena::s_vertices;
+GeometryArena::RangeAllocator GeometryArena::s_indices;
+uint32_t GeometryArena::s_generation = 0;
+
+// --- RangeAllocator ---
+
+void GeometryArena::RangeAllocator::reset(uint32_t capacity) {
+  m_free.clear();
+  m_capacity = capacity;
+  if (capacity > 0) {
+    m_free.push_back({0, capacity});
+  }
+}
+
+void GeometryArena::RangeAllocator::grow(uint32_t capacity) {
+  if (capacity <= m_capacity) {
+    return;
+  }
+  const uint32_t added = capacity - m_capacity;
+  if (!m_free.empty() &&
+      m_free.back().offset + m_free.back().count == m_capacity) {
+    m_free.back().count += added;
+  } else {
+    m_free.push_back({m_capacity, added});
+  }
+  m_capacity = capacity;
+}
+
+uint32_t GeometryArena::RangeAllocator::allocate(uint32_t count) {
+  for (size_t i = 0; i < m_free.size(); ++i) {
+    Range &range = m_free[i];
+    if (range.count < count) {
+      continue;
+    }
+    const uint32_t offset = range.offset;
+    range.offset += count;
+    range.count -= count;
+    if (range.count == 0) {
+      m_free.erase(m_free.begin() + i);
+    }
+    return offset;
+  }
+  return INVALID;
+}
+
+void GeometryArena::RangeAllocator::release(uint32_t offset, uint32_t count) {
+  if (count == 0 || offset + count > m_capacity) {
+    return;
+  }
+  auto next = std::lower_bound(
+      m_free.begin(), m_free.end(), offset,
+      [](const Range &range, uint32_t value) { return range.offset < value; });
+  // Merge with the free neighbours on either side.
+  const bool joins_prev =
+      next != m_free.begin() &&
+      std::prev(next)->offset + std::prev(next)->count == offset;
+  const bool joins_next =
+      next != m_free.end() && offset + count == next->offset;
+  if (joins_prev && joins_next) {
+    std::prev(next)->count += count + next->count;
+    m_free.erase(next);
+  } else if (joins_prev) {
+    std::prev(next)->count += count;
+  } else if (joins_next) {
+    next->offset = offset;
+    next->count += count;
+  } else {
+    m_free.insert(next, {offset, count});
+  }
+}
+
+// --- Arena ---
+
+bool GeometryArena::create() {
+  if (s_vao != 0) {
+    return true;
+  }
+
+  glGenBuffers(1, &s_vbo);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, s_vbo);
+  glBufferData(GL_COPY_WRITE_BUFFER,
+               static_cast<GLsizeiptr>(INITIAL_VERTEX_CAPACITY * sizeof(Vertex)),
+               nullptr, GL_STATIC_DRAW);
+  glGenBuffers(1, &s_ebo);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, s_ebo);
+  glBufferData(GL_COPY_WRITE_BUFFER,
+               static_cast<GLsizeiptr>(INITIAL_INDEX_CAPACITY *
+                                       sizeof(unsigned int)),
+               nullptr, GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  s_vertices.reset(INITIAL_VERTEX_CAPACITY);
+  s_indices.reset(INITIAL_INDEX_CAPACITY);
+  // Slices of the previous buffers may still be released later; the new
+  // generation tells release() to ignore them.
+  s_generation++;
+
+  // Attribute formats are separate from the buffers, so growing a buffer
+  // only has to swap the binding.
+  glGenVertexArrays(1, &s_vao);
+  GLState::bind_vertex_array(s_vao);
+  glEnableVertexAttribArray(0);
+  glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Position));
+  glVertexAttribBinding(0, VERTEX_BINDING);
+  glEnableVertexAttribArray(1);
+  glVertexAttribFormat(1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Normal));
+  glVertexAttribBinding(1, VERTEX_BINDING);
+  glEnableVertexAttribArray(2);
+  glVertexAttribFormat(2, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, TexCoords));
+  glVertexAttribBinding(2, VERTEX_BINDING);
+
+  // A mat4 attribute occupies four consecutive locations (3-6), one vec4
+  // column each, advanced once per instance instead of once per vertex.
+  for (unsigned int column = 0; column < 4; ++column) {
+    const unsigned int location = 3 + column;
+    glEnableVertexAttribArray(location);
+    glVertexAttribFormat(location, 4, GL_FLOAT, GL_FALSE,
+                         column * sizeof(glm::vec4));
+    glVertexAttribBinding(location, INSTANCE_BINDING);
+  }
+  glVertexBindingDivisor(INSTANCE_BINDING, 1);
+
+  // Core profile rejects draws with an enabled attribute that has no buffer,
+  // so non-instanced draws read a single identity matrix until something
+  // else is bound.
+  const glm::mat4 identity(1.0f);
+  glGenBuffers(1, &s_identity_instance);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, s_identity_instance);
+  glBufferData(GL_COPY_WRITE_BUFFER, sizeof(identity), &identity,
+               GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  glBindVertexBuffer(INSTANCE_BINDING, s_identity_instance, 0,
+                     sizeof(glm::mat4));
+
+  attach_buffers();
+  return true;
+}
+
+void GeometryArena::attach_buffers() {
+  GLState::bind_vertex_array(s_vao);
+  glBindVertexBuffer(VERTEX_BINDING, s_vbo, 0, sizeof(Vertex));
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_ebo);
+  // Unbind so later element buffer binds can't change the VAO.
+  GLState::bind_vertex_array(0);
+}
+
+void GeometryArena::grow(unsigned int &buffer, RangeAllocator &allocator,
+                         uint32_t min_capacity, size_t element_size) {
+  const uint32_t old_capacity = allocator.capacity();
+  const uint32_t capacity = std::max(min_capacity, old_capacity * 2);
+
+  unsigned int grown = 0;
+  glGenBuffers(1, &grown);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+  glBufferData(GL_COPY_WRITE_BUFFER,
+               static_cast<GLsizeiptr>(capacity * element_size), nullptr,
+               GL_STATIC_DRAW);
+  // Copy on the GPU; the data never comes back to the CPU.
+  glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+  glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                      static_cast<GLsizeiptr>(old_capacity * element_size));
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  glDeleteBuffers(1, &buffer);
+
+  buffer = grown;
+  allocator.grow(capacity);
+  attach_buffers();
+  Log::info("GeometryArena: grew a buffer to " + std::to_string(capacity) +
+            " elements.");
+}
+
+uint32_t GeometryArena::allocate_range(unsigned int &buffer,
+                                       RangeAllocator &allocator,
+                                       uint32_t count, size_t element_size) {
+  uint32_t offset = allocator.allocate(count);
+  if (offset == RangeAllocator::INVALID) {
+    grow(buffer, allocator, allocator.capacity() + count, element_size);
+    offset = allocator.allocate(count);
+  }
+  return offset;
+}
+
+GeometrySlice GeometryArena::allocate(const Vertex *vertices,
+                                      uint32_t vertex_count,
+                                      const unsigned int *indices,
+                                      uint32_t index_count) {
+  if (vertex_count == 0 || !create()) {
+    return GeometrySlice{};
+  }
+
+  GeometrySlice slice;
+  slice.vertex_count = vertex_count;
+  slice.index_count = index_count;
+  slice.generation = s_generation;
+  slice.base_vertex =
+      allocate_range(s_vbo, s_vertices, vertex_count, sizeof(Vertex));
+  slice.first_index =
+      index_count > 0 ? allocate_range(s_ebo, s_indices, index_count,
+                                       sizeof(unsigned int))
+                      : 0;
+
+  glBindBuffer(GL_COPY_WRITE_BUFFER, s_vbo);
+  glBufferSubData(GL_COPY_WRITE_BUFFER,
+                  static_cast<GLintptr>(slice.base_vertex * sizeof(Vertex)),
+                  static_cast<GLsizeiptr>(vertex_count * sizeof(Vertex)),
+                  vertices);
+  if (index_count > 0) {
+    // Indices stay relative to the mesh; draws add base_vertex.
+    glBindBuffer(GL_COPY_WRITE_BUFFER, s_ebo);
+    glBufferSubData(
+        GL_COPY_WRITE_BUFFER,
+        static_cast<GLintptr>(slice.first_index * sizeof(unsigned int)),
+        static_cast<GLsizeiptr>(index_count * sizeof(unsigned int)), indices);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  return slice;
+}
+
+void GeometryArena::release(const GeometrySlice &slice) {
+  if (!slice.is_valid() || slice.generation != s_generation) {
+    return;
+  }
+  s_vertices.release(slice.base_vertex, slice.vertex_count);
+  s_indices.release(slice.first_index, slice.index_count);
+}
+
+unsigned int GeometryArena::get_vertex_array() {
+  create();
+  return s_vao;
+}
+
+void GeometryArena::bind_instance_buffer(unsigned int buffer) {
+  GLState::bind_vertex_array(get_vertex_array());
+  glBindVertexBuffer(INSTANCE_BINDING, buffer, 0, sizeof(glm::mat4));
+}
+
+void GeometryArena::shutdown() {
+  if (s_vao != 0) {
+    GLState::delete_vertex_array(s_vao);
+    glDeleteBuffers(1, &s_vbo);
+    glDeleteBuffers(1, &s_ebo);
+    glDeleteBuffers(1, &s_identity_instance);
+    s_vao = s_vbo = s_ebo = s_identity_instance = 0;
+  }
+  s_vertices.reset(0);
+  s_indices.reset(0);
+}
@@ -0,0 +1,233 @@
+#include "graphics/GpuProfiler.h"
+#include "utils/Log.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+bool GpuProfiler::s_enabled = true;
+bool GpuProfiler::s_in_frame = false;
+unsigned int GpuProfiler::s_frame = 0;
+GpuProfiler::FrameQueries GpuProfiler::s_frames[FRAME_LATENCY];
+std::vector<GpuProfiler::PassHistory> GpuProfiler::s_passes;
+std::vector<size_t> GpuProfiler::s_open;
+unsigned int GpuProfiler::s_skipped_frames = 0;
+
+namespace {
+constexpr const char *FRAME_PASS = "frame";
+} // namespace
+
+void GpuProfiler::shutdown() {
+  for (FrameQueries &frame : s_frames) {
+    if (!frame.pool.empty()) {
+      glDeleteQueries(static_cast<GLsizei>(frame.pool.size()),
+                      frame.pool.data());
+    }
+    frame = FrameQueries{};
+  }
+  s_open.clear();
+  s_in_frame = false;
+}
+
+void GpuProfiler::set_enabled(bool enabled) {
+  if (s_in_frame) {
+    end_frame();
+  }
+  s_enabled = enabled;
+  // Results queued while enabled would be stale by the time it's back on.
+  for (FrameQueries &frame : s_frames) {
+    frame.queries.clear();
+    frame.submitted = false;
+  }
+}
+
+void GpuProfiler::begin_frame() {
+  if (!s_enabled) {
+    return;
+  }
+  s_frame = (s_frame + 1) % FRAME_LATENCY;
+  FrameQueries &frame = s_frames[s_frame];
+  // This slot last ran FRAME_LATENCY frames ago. Rarely the GPU is further
+  // behind than that; drop the frame rather than wait for it.
+  if (frame.submitted && !collect(frame)) {
+    s_skipped_frames++;
+  }
+  frame.used = 0;
+  frame.queries.clear();
+  frame.submitted = false;
+  s_open.clear();
+  s_in_frame = true;
+  begin_pass(FRAME_PASS);
+}
+
+void GpuProfiler::end_frame() {
+  if (!s_in_frame) {
+    return;
+  }
+  // Close anything a pass left open so the frame's results stay usable.
+  while (!s_open.empty()) {
+    end_pass();
+  }
+  s_frames[s_frame].submitted = true;
+  s_in_frame = false;
+}
+
+void GpuProfiler::begin_pass(const char *name) {
+  if (!s_in_frame) {
+    return;
+  }
+  FrameQueries &frame = s_frames[s_frame];
+  const uint32_t pass =
+      find_pass(name, static_cast<unsigned int>(s_open.size()));
+  const unsigned int begin = next_query();
+  glQueryCounter(begin, GL_TIMESTAMP);
+  s_open.push_back(frame.queries.size());
+  frame.queries.push_back(Query{pass, begin, 0});
+}
+
+void GpuProfiler::end_pass() {
+  if (!s_in_frame || s_open.empty()) {
+    return;
+  }
+  FrameQueries &frame = s_frames[s_frame];
+  Query &query = frame.queries[s_open.back()];
+  s_open.pop_back();
+  query.end = next_query();
+  glQueryCounter(query.end, GL_TIMESTAMP);
+}
+
+uint32_t GpuProfiler::find_pass(const char *name, unsigned int depth) {
+  for (size_t i = 0; i < s_passes.size(); ++i) {
+    if (s_passes[i].depth == depth && s_passes[i].name == name) {
+      return static_cast<uint32_t>(i);
+    }
+  }
+  s_passes.emplace_back();
+  s_passes.back().name = name;
+  s_passes.back().depth = depth;
+  return static_cast<uint32_t>(s_passes.size() - 1);
+}
+
+unsigned int GpuProfiler::next_query() {
+  FrameQueries &frame = s_frames[s_frame];
+  if (frame.used == frame.pool.size()) {
+    // Grow in blocks; a frame's pass count is small and stable.
+    const size_t first = frame.pool.size();
+    frame.pool.resize(first + 16);
+    glGenQueries(16, frame.pool.data() + first);
+  }
+  return frame.pool[frame.used++];
+}
+
+bool GpuProfiler::collect(FrameQueries &frame) {
+  // Queries complete in order, so the last one issued answers for all of
+  // them. That is the frame pass's end, not the last entry in `queries`:
+  // queries are listed by begin, and the frame pass ends after its children.
+  if (frame.queries.empty() || frame.used == 0) {
+    return true;
+  }
+  GLint available = 0;
+  glGetQueryObjectiv(frame.pool[frame.used - 1], GL_QUERY_RESULT_AVAILABLE,
+                     &available);
+  if (!available) {
+    return false;
+  }
+
+  for (PassHistory &pass : s_passes) {
+    pass.frame_ms = 0.0f;
+    pass.seen = false;
+  }
+  for (const Query &query : frame.queries) {
+    GLuint64 begin = 0;
+    GLuint64 end = 0;
+    glGetQueryObjectui64v(query.begin, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(query.end, GL_QUERY_RESULT, &end);
+    PassHistory &pass = s_passes[query.pass];
+    pass.frame_ms += static_cast<float>(end - begin) * 1e-6f;
+    pass.seen = true;
+  }
+  for (PassHistory &pass : s_passes) {
+    if (!pass.seen) {
+      continue;
+    }
+    pass.samples[pass.next] = pass.frame_ms;
+    pass.next = (pass.next + 1) % HISTORY_SIZE;
+    pass.count = std::min(pass.count + 1, HISTORY_SIZE);
+  }
+  return true;
+}
+
+std::vector<GpuProfiler::PassStats> GpuProfiler::get_stats() {
+  std::vector<PassStats> stats;
+  stats.reserve(s_passes.size());
+  for (const PassHistory &pass : s_passes) {
+    PassStats entry;
+    entry.name = pass.name;
+    entry.depth = pass.depth;
+    entry.samples = pass.count;
+    if (pass.count > 0) {
+      entry.last_ms = pass.samples[(pass.next + HISTORY_SIZE - 1) %
+                                   HISTORY_SIZE];
+      entry.min_ms = pass.samples[0];
+      entry.max_ms = pass.samples[0];
+      float sum = 0.0f;
+      for (unsigned int i = 0; i < pass.count; ++i) {
+        entry.min_ms = std::min(entry.min_ms, pass.samples[i]);
+        entry.max_ms = std::max(entry.max_ms, pass.samples[i]);
+        sum += pass.samples[i];
+      }
+      entry.avg_ms = sum / static_cast<float>(pass.count);
+    }
+    stats.push_back(entry);
+  }
+  return stats;
+}
+
+std::string GpuProfiler::get_report() {
+  std::string report = "GPU pass         last     min     avg     max (ms)\n";
+  char line[128];
+  for (const PassStats &pass : get_stats()) {
+    const std::string name = std::string(pass.depth * 2, ' ') + pass.name;
+    std::snprintf(line, sizeof(line), "%-14s %7.3f %7.3f %7.3f %7.3f\n",
+                  name.c_str(), pass.last_ms, pass.min_ms, pass.avg_ms,
+                  pass.max_ms);
+    report += line;
+  }
+  if (s_skipped_frames > 0) {
+    report += std::to_string(s_skipped_frames) +
+              " frames skipped waiting for results\n";
+  }
+  return report;
+}
+
+bool GpuProfiler::write_json(const std::string &path) {
+  std::ofstream out(path);
+  if (!out) {
+    Log::error("GpuProfiler: failed to open " + path);
+    return false;
+  }
+  out << "{\n  \"skipped_frames\": " << s_skipped_frames
+      << ",\n  \"passes\": [";
+  const auto stats = get_stats();
+  for (size_t i = 0; i < stats.size(); ++i) {
+    const PassStats &pass = stats[i];
+    // Pass names are code identifiers; nothing to escape.
+    out << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << pass.name
+        << "\", \"depth\": " << pass.depth << ", \"samples\": " << pass.samples
+        << ", \"last_ms\": " << pass.last_ms << ", \"min_ms\": " << pass.min_ms
+        << ", \"avg_ms\": " << pass.avg_ms << ", \"max_ms\": " << pass.max_ms
+        << "}";
+  }
+  out << "\n  ]\n}\n";
+  Log::info("GpuProfiler: wrote " + path);
+  return static_cast<bool>(out);
+}
+
+void GpuProfiler::reset() {
+  for (PassHistory &pass : s_passes) {
+    pass.count = 0;
+    pass.next = 0;
+  }
+  s_skipped_frames = 0;
+}
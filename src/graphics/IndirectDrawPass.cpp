@@ -0,0 +1,280 @@
+#include "graphics/IndirectDrawPass.h"
+#include "graphics/GLState.h"
+#include "graphics/GeometryArena.h"
+#include "graphics/GpuProfiler.h"
+#include "graphics/Mesh.h"
+#include "graphics/Shader.h"
+#include "scene/Scene.h"
+#include "utils/Log.h"
+#include <algorithm>
+#include <cstring>
+#include <glad/glad.h>
+#include <unordered_map>
+
+namespace {
+// Shader storage bindings, as declared in cull.comp
+constexpr unsigned int COMMAND_BINDING = 0;
+constexpr unsigned int OBJECT_BINDING = 1;
+constexpr unsigned int TRANSFORM_BINDING = 2;
+constexpr unsigned int SPHERE_BINDING = 3;
+constexpr unsigned int INSTANCE_BINDING = 4;
+
+constexpr UniformName U_PLANES("u_planes");
+constexpr UniformName U_OBJECT_COUNT("u_object_count");
+constexpr UniformName U_TEXTURE("u_texture");
+
+// Room for this many matrices per frame before the stream has to grow
+constexpr size_t INITIAL_TRANSFORM_CAPACITY = 4096;
+} // namespace
+
+static_assert(sizeof(glm::uvec2) == 8, "Object records must be two uints");
+
+IndirectDrawPass::~IndirectDrawPass() {
+  for (unsigned int *buffer :
+       {&m_command_buffer, &m_object_buffer, &m_sphere_buffer,
+        &m_instance_buffer, &m_transform_buffer}) {
+    if (*buffer != 0) {
+      glDeleteBuffers(1, buffer);
+    }
+  }
+}
+
+bool IndirectDrawPass::is_supported() { return GLAD_GL_VERSION_4_3 != 0; }
+
+bool IndirectDrawPass::init(std::shared_ptr<Shader> cull_shader) {
+  if (!is_supported() || !cull_shader) {
+    return false;
+  }
+  m_cull_shader = std::move(cull_shader);
+  m_planes_location = m_cull_shader->get_uniform(U_PLANES).location;
+  m_object_count_location =
+      m_cull_shader->get_uniform(U_OBJECT_COUNT).location;
+  if (m_planes_location < 0 || m_object_count_location < 0) {
+    Log::error("IndirectDrawPass: the cull shader is missing u_planes or "
+               "u_object_count.");
+    return false;
+  }
+
+  GLint alignment = 0;
+  glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  m_storage_alignment = static_cast<size_t>(std::max(alignment, 16));
+  m_use_transform_stream =
+      StreamBuffer::is_supported() &&
+      m_transform_stream.init(INITIAL_TRANSFORM_CAPACITY * sizeof(glm::mat4));
+  return true;
+}
+
+void IndirectDrawPass::upload(unsigned int &buffer, size_t &capacity,
+                              const void *data, size_t bytes) {
+  if (buffer == 0) {
+    glGenBuffers(1, &buffer);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+  if (bytes > capacity) {
+    capacity = std::max(bytes, capacity * 2);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(capacity),
+                 nullptr, GL_DYNAMIC_DRAW);
+  }
+  if (data && bytes > 0) {
+    glBufferSubData(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(bytes),
+                    data);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void IndirectDrawPass::rebuild(const Scene &scene) {
+  const World &world = scene.get_world();
+  const TransformStore &transforms = scene.get_transform_store();
+
+  // 1. Count objects per mesh.
+  std::unordered_map<const Mesh *, uint32_t> mesh_counts;
+  world.each_chunk<const TransformLink, const MeshRef>(
+      [&](uint32_t count, const Entity *, const TransformLink *,
+          const MeshRef *meshes) {
+        for (uint32_t i = 0; i < count; ++i) {
+          if (meshes[i].mesh->get_geometry().index_count > 0) {
+            mesh_counts[meshes[i].mesh.get()]++;
+          }
+        }
+      });
+
+  // 2. One command per mesh, sorted so meshes sharing a texture are
+  // contiguous and each texture is one multi-draw.
+  std::vector<const Mesh *> meshes;
+  meshes.reserve(mesh_counts.size());
+  for (const auto &[mesh, count] : mesh_counts) {
+    meshes.push_back(mesh);
+  }
+  std::sort(meshes.begin(), meshes.end(), [](const Mesh *a, const Mesh *b) {
+    if (a->get_texture_id() != b->get_texture_id()) {
+      return a->get_texture_id() < b->get_texture_id();
+    }
+    return a->get_geometry().first_index < b->get_geometry().first_index;
+  });
+
+  m_commands.clear();
+  m_groups.clear();
+  m_mesh_spheres.clear();
+  std::unordered_map<const Mesh *, uint32_t> mesh_command;
+  uint32_t instances = 0;
+  for (const Mesh *mesh : meshes) {
+    const GeometrySlice &geometry = mesh->get_geometry();
+    const uint32_t command = static_cast<uint32_t>(m_commands.size());
+    mesh_command.emplace(mesh, command);
+
+    DrawCommand draw;
+    draw.count = geometry.index_count;
+    draw.first_index = geometry.first_index;
+    draw.base_vertex = static_cast<int32_t>(geometry.base_vertex);
+    draw.base_instance = instances; // Room for every object of the mesh
+    m_commands.push_back(draw);
+    instances += mesh_counts[mesh];
+
+    const MeshBounds &bounds = mesh->get_bounds();
+    m_mesh_spheres.emplace_back(bounds.center, bounds.radius);
+
+    const unsigned int texture = mesh->get_texture_id();
+    if (m_groups.empty() || m_groups.back().texture != texture) {
+      m_groups.push_back({texture, command, 0});
+    }
+    m_groups.back().command_count++;
+  }
+
+  // 3. The object records the compute pass walks.
+  m_objects.clear();
+  m_objects.reserve(instances);
+  world.each_chunk<const TransformLink, const MeshRef>(
+      [&](uint32_t count, const Entity *, const TransformLink *links,
+          const MeshRef *refs) {
+        for (uint32_t i = 0; i < count; ++i) {
+          auto it = mesh_command.find(refs[i].mesh.get());
+          if (it != mesh_command.end()) {
+            m_objects.emplace_back(transforms.dense_index(links[i].handle),
+                                   it->second);
+          }
+        }
+      });
+
+  upload(m_object_buffer, m_object_capacity, m_objects.data(),
+         m_objects.size() * sizeof(glm::uvec2));
+  upload(m_sphere_buffer, m_sphere_capacity, m_mesh_spheres.data(),
+         m_mesh_spheres.size() * sizeof(glm::vec4));
+  // Every object may be visible, so the output needs a slot per object.
+  upload(m_instance_buffer, m_instance_capacity, nullptr,
+         m_objects.size() * sizeof(glm::mat4));
+
+  m_world = &world;
+  m_transforms = &transforms;
+  m_world_layout_version = world.get_layout_version();
+  m_transform_layout_version = transforms.get_layout_version();
+}
+
+void IndirectDrawPass::draw(const Scene &scene, const Frustum &frustum,
+                            Shader &shader) {
+  const World &world = scene.get_world();
+  const TransformStore &transforms = scene.get_transform_store();
+  if (m_world != &world || m_transforms != &transforms ||
+      m_world_layout_version != world.get_layout_version() ||
+      m_transform_layout_version != transforms.get_layout_version()) {
+    rebuild(scene);
+  }
+  if (m_objects.empty()) {
+    return;
+  }
+
+  // 1. Reset the instance counts and bring the transforms up to date.
+  upload(m_command_buffer, m_command_capacity, m_commands.data(),
+         m_commands.size() * sizeof(DrawCommand));
+
+  const auto &world_matrices = transforms.render_matrices();
+  const size_t transform_bytes = world_matrices.size() * sizeof(glm::mat4);
+  bool streamed = false;
+  if (m_use_transform_stream) {
+    m_transform_stream.begin_frame();
+    if (m_transform_stream.reserve(transform_bytes)) {
+      const auto allocation =
+          m_transform_stream.allocate(transform_bytes, m_storage_alignment);
+      if (allocation.data) {
+        std::memcpy(allocation.data, world_matrices.data(), transform_bytes);
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, TRANSFORM_BINDING,
+                          m_transform_stream.get_id(),
+                          static_cast<GLintptr>(allocation.offset),
+                          static_cast<GLsizeiptr>(transform_bytes));
+        streamed = true;
+      }
+    }
+    if (!streamed) {
+      // Growing the stream failed: upload into a regular buffer from now on.
+      Log::warn("IndirectDrawPass: transform stream unavailable; falling "
+                "back to buffer uploads.");
+      m_use_transform_stream = false;
+    }
+  }
+  if (!streamed) {
+    upload(m_transform_buffer, m_transform_capacity, world_matrices.data(),
+           transform_bytes);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TRANSFORM_BINDING,
+                     m_transform_buffer);
+  }
+
+  // 2. Cull on the GPU.
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING,
+                   m_command_buffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_BINDING, m_object_buffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SPHERE_BINDING, m_sphere_buffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING,
+                   m_instance_buffer);
+
+  const uint32_t object_count = static_cast<uint32_t>(m_objects.size());
+  GpuProfiler::begin_pass("cull");
+  m_cull_shader->use();
+  glUniform4fv(m_planes_location, Frustum::PLANE_COUNT, &frustum.planes[0][0]);
+  glUniform1ui(m_object_count_location, object_count);
+  glDispatchCompute((object_count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1,
+                    1);
+  GpuProfiler::end_pass();
+  // The draws read the commands as indirect parameters and the instances as
+  // vertex attributes, and next frame's reset rewrites the commands with
+  // glBufferSubData.
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT |
+                  GL_BUFFER_UPDATE_BARRIER_BIT);
+
+  // 3. Draw every mesh from its command; culled meshes have zero instances.
+  shader.use();
+  shader.set_int(shader.get_uniform(U_TEXTURE), 0);
+  GeometryArena::bind_instance_buffer(m_instance_buffer);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_command_buffer);
+  for (const DrawGroup &group : m_groups) {
+    GLState::bind_texture(0, group.texture);
+    glMultiDrawElementsIndirect(
+        GL_TRIANGLES, GL_UNSIGNED_INT,
+        (void *)(static_cast<size_t>(group.first_command) *
+                 sizeof(DrawCommand)),
+        static_cast<GLsizei>(group.command_count), sizeof(DrawCommand));
+  }
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+  if (m_use_transform_stream) {
+    m_transform_stream.end_frame();
+  }
+}
+
+std::vector<uint32_t> IndirectDrawPass::read_instance_counts() const {
+  std::vector<DrawCommand> commands(m_commands.size());
+  if (commands.empty()) {
+    return {};
+  }
+  glBindBuffer(GL_COPY_READ_BUFFER, m_command_buffer);
+  glGetBufferSubData(GL_COPY_READ_BUFFER, 0,
+                     static_cast<GLsizeiptr>(commands.size() *
+                                             sizeof(DrawCommand)),
+                     commands.data());
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+  std::vector<uint32_t> counts;
+  counts.reserve(commands.size());
+  for (const DrawCommand &command : commands) {
+    counts.push_back(command.instance_count);
+  }
+  return counts;
+}
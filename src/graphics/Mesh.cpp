@@ -1,38 +1,39 @@
 #include "graphics/Mesh.h"
+#include "graphics/GeometryArena.h"
+#include "graphics/GLState.h"
 #include "graphics/Texture.h"
+#include <algorithm>
+#include <cmath>
 #include <glad/glad.h>
 #include <utility> // For std::move
 
+namespace {
+constexpr UniformName U_TEXTURE("u_texture");
+} // namespace
+
 // Constructor: Initializes the mesh with data and sets up GPU buffers.
 Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices,
            std::vector<std::shared_ptr<Texture>> textures)
     : vertices(std::move(vertices)), indices(std::move(indices)),
       textures(std::move(textures)) {
+  compute_bounds();
   // Now that we have all the required data, set up the vertex buffers and
   // attribute pointers.
   setup_mesh();
 }
 
-// Destructor: Cleans up the GPU resources when the mesh object is destroyed.
-Mesh::~Mesh() {
-  // Only try to delete if the handles are valid (not 0)
-  if (m_vao != 0) {
-    glDeleteVertexArrays(1, &m_vao);
-    glDeleteBuffers(1, &m_vbo);
-    glDeleteBuffers(1, &m_ebo);
-  }
-}
+// Destructor: Returns the mesh's geometry to the shared arena.
+Mesh::~Mesh() { GeometryArena::release(m_geometry); }
 
-// Move Constructor: Transfers ownership of GPU resources from another mesh.
+// Move Constructor: Transfers ownership of the geometry slice from another
+// mesh.
 Mesh::Mesh(Mesh &&other) noexcept
     : vertices(std::move(other.vertices)), indices(std::move(other.indices)),
-      textures(std::move(other.textures)), m_vao(other.m_vao),
-      m_vbo(other.m_vbo), m_ebo(other.m_ebo) {
-  // Prevent the moved-from object's destructor from freeing the buffers by
-  // setting its handles to 0. This is crucial for preventing double-deletion.
-  other.m_vao = 0;
-  other.m_vbo = 0;
-  other.m_ebo = 0;
+      textures(std::move(other.textures)), m_geometry(other.m_geometry),
+      m_bounds(other.m_bounds) {
+  // Prevent the moved-from object's destructor from releasing the slice.
+  // This is crucial for preventing double-release.
+  other.m_geometry = GeometrySlice{};
 }
 
 // Move Assignment Operator: Transfers ownership from another mesh.
@@ -40,86 +41,110 @@ Mesh &Mesh::operator=(Mesh &&other) noexcept {
   // 1. Check for self-assignment
   if (this != &other) {
     // 2. Free existing resources of the current object
-    if (m_vao != 0) {
-      glDeleteVertexArrays(1, &m_vao);
-      glDeleteBuffers(1, &m_vbo);
-      glDeleteBuffers(1, &m_ebo);
-    }
+    GeometryArena::release(m_geometry);
 
-    // 3. Move data and resource handles from the other object
+    // 3. Move data and the slice from the other object
     vertices = std::move(other.vertices);
     indices = std::move(other.indices);
     textures = std::move(other.textures);
-    m_vao = other.m_vao;
-    m_vbo = other.m_vbo;
-    m_ebo = other.m_ebo;
-
-    // 4. Prevent the other object's destructor from freeing the resources
-    other.m_vao = 0;
-    other.m_vbo = 0;
-    other.m_ebo = 0;
+    m_geometry = other.m_geometry;
+    m_bounds = other.m_bounds;
+
+    // 4. Prevent the other object's destructor from releasing the slice
+    other.m_geometry = GeometrySlice{};
   }
   return *this;
 }
 
-// Creates and configures the VAO, VBO, and EBO for the mesh.
+// Computes the AABB, then a sphere around its center that just reaches the
+// farthest vertex (tighter than the box's half-diagonal).
+void Mesh::compute_bounds() {
+  m_bounds = MeshBounds{};
+  if (vertices.empty()) {
+    return;
+  }
+  m_bounds.min = m_bounds.max = vertices[0].Position;
+  for (const Vertex &vertex : vertices) {
+    m_bounds.min = glm::min(m_bounds.min, vertex.Position);
+    m_bounds.max = glm::max(m_bounds.max, vertex.Position);
+  }
+  m_bounds.center = (m_bounds.min + m_bounds.max) * 0.5f;
+  float radius_sq = 0.0f;
+  for (const Vertex &vertex : vertices) {
+    glm::vec3 offset = vertex.Position - m_bounds.center;
+    radius_sq = std::max(radius_sq, glm::dot(offset, offset));
+  }
+  m_bounds.radius = std::sqrt(radius_sq);
+}
+
+// Uploads the mesh into the shared geometry arena. The arena's VAO already
+// describes the Vertex layout, so there is nothing else to configure.
 void Mesh::setup_mesh() {
-  // 1. Create buffers/arrays
-  glGenVertexArrays(1, &m_vao);
-  glGenBuffers(1, &m_vbo);
-  glGenBuffers(1, &m_ebo);
-
-  // 2. Bind the Vertex Array Object first, then bind and set vertex buffer(s),
-  // and then configure vertex attributes(s).
-  glBindVertexArray(m_vao);
-
-  // 3. Copy our vertices array into a vertex buffer for OpenGL to use
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0],
-               GL_STATIC_DRAW);
-
-  // 4. Copy our index array in a element buffer for OpenGL to use
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
-               &indices[0], GL_STATIC_DRAW);
-
-  // 5. Set the vertex attribute pointers
-  // Vertex Positions
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-
-  // Vertex Normals
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, Normal));
-
-  // Vertex Texture Coords
-  glEnableVertexAttribArray(2);
-  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, TexCoords));
-
-  // Unbind the VAO
-  glBindVertexArray(0);
+  m_geometry = GeometryArena::allocate(
+      vertices.data(), static_cast<uint32_t>(vertices.size()), indices.data(),
+      static_cast<uint32_t>(indices.size()));
+}
+
+unsigned int Mesh::get_vertex_array() const {
+  return GeometryArena::get_vertex_array();
+}
+
+unsigned int Mesh::get_texture_id() const {
+  return !textures.empty() && textures[0] ? textures[0]->get_id() : 0;
 }
 
 // Renders the mesh.
 void Mesh::draw(Shader &shader) {
+  if (!m_geometry.is_valid()) {
+    return;
+  }
   // Bind the first texture if it exists.
   // A more advanced system would loop through all textures.
   if (!textures.empty() && textures[0]) {
-    shader.set_int("u_texture", 0); // Tell shader to use texture unit 0
+    // Tell shader to use texture unit 0
+    shader.set_int(shader.get_uniform(U_TEXTURE), 0);
     textures[0]->bind(0);
   }
+  // Otherwise whatever the caller bound stays bound (see ComputeRenderer).
+
+  // Every mesh shares the arena's VAO, so after the first draw of a frame
+  // this bind is free. base_vertex rebases the mesh-relative indices.
+  GLState::bind_vertex_array(GeometryArena::get_vertex_array());
+  glDrawElementsBaseVertex(
+      GL_TRIANGLES, static_cast<GLsizei>(m_geometry.index_count),
+      GL_UNSIGNED_INT,
+      (void *)(static_cast<size_t>(m_geometry.first_index) *
+               sizeof(unsigned int)),
+      static_cast<GLint>(m_geometry.base_vertex));
+}
 
-  // Bind the VAO and draw the elements
-  glBindVertexArray(m_vao);
-  glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()),
-                 GL_UNSIGNED_INT, 0);
+// Renders many copies of the mesh with one draw call.
+void Mesh::draw_instanced(Shader &shader, unsigned int instance_vbo,
+                          unsigned int instance_count,
+                          unsigned int base_instance) {
+  if (instance_count == 0 || !m_geometry.is_valid()) {
+    return;
+  }
 
-  // Unbind the VAO to be clean
-  glBindVertexArray(0);
+  if (!textures.empty() && textures[0]) {
+    shader.set_int(shader.get_uniform(U_TEXTURE), 0);
+    textures[0]->bind(0);
+  } else {
+    // Sample no texture rather than whatever the last batch left bound.
+    GLState::bind_texture(0, 0);
+  }
 
-  // Unbind texture
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, 0);
+  // Rebound on every draw: streamed instance buffers are recreated when they
+  // grow, and a recycled GL name would defeat an id comparison. This also
+  // binds the shared VAO.
+  GeometryArena::bind_instance_buffer(instance_vbo);
+  // base_instance offsets the fetch of the per-instance attributes, so every
+  // batch can live in the same buffer.
+  glDrawElementsInstancedBaseVertexBaseInstance(
+      GL_TRIANGLES, static_cast<GLsizei>(m_geometry.index_count),
+      GL_UNSIGNED_INT,
+      (void *)(static_cast<size_t>(m_geometry.first_index) *
+               sizeof(unsigned int)),
+      static_cast<GLsizei>(instance_count),
+      static_cast<GLint>(m_geometry.base_vertex), base_instance);
 }
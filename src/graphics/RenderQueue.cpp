@@ -0,0 +1,81 @@
+#include "graphics/RenderQueue.h"
+#include <cstring>
+#include <utility>
+
+static_assert(RenderQueue::SHADER_BITS + RenderQueue::TEXTURE_BITS +
+                      RenderQueue::MESH_BITS + RenderQueue::DEPTH_BITS ==
+                  64,
+              "Render key fields must fill 64 bits");
+
+namespace {
+constexpr uint64_t field_mask(uint32_t bits) {
+  return (uint64_t(1) << bits) - 1;
+}
+
+// Below this many items a comparison sort beats eight counting passes.
+constexpr size_t INSERTION_SORT_LIMIT = 32;
+} // namespace
+
+uint64_t RenderQueue::make_key(uint32_t shader, uint32_t texture,
+                               uint32_t mesh, float depth) {
+  // The bit pattern of a non-negative float grows with its value, so its top
+  // bits quantize depth with constant relative precision and no range.
+  if (!(depth > 0.0f)) {
+    depth = 0.0f; // Also catches NaN
+  }
+  uint32_t depth_bits;
+  std::memcpy(&depth_bits, &depth, sizeof(depth_bits));
+
+  uint64_t key = shader & field_mask(SHADER_BITS);
+  key = (key << TEXTURE_BITS) | (texture & field_mask(TEXTURE_BITS));
+  key = (key << MESH_BITS) | (mesh & field_mask(MESH_BITS));
+  key = (key << DEPTH_BITS) | (depth_bits >> (32 - DEPTH_BITS));
+  return key;
+}
+
+void RenderQueue::sort() {
+  const size_t count = m_items.size();
+  if (count <= INSERTION_SORT_LIMIT) {
+    for (size_t i = 1; i < count; ++i) {
+      const Item item = m_items[i];
+      size_t j = i;
+      for (; j > 0 && m_items[j - 1].key > item.key; --j) {
+        m_items[j] = m_items[j - 1];
+      }
+      m_items[j] = item;
+    }
+    return;
+  }
+
+  // Histogram every byte in one read of the keys.
+  uint32_t counts[8][256] = {};
+  for (const Item &item : m_items) {
+    for (uint32_t pass = 0; pass < 8; ++pass) {
+      counts[pass][(item.key >> (pass * 8)) & 0xff]++;
+    }
+  }
+
+  m_scratch.resize(count);
+  Item *src = m_items.data();
+  Item *dst = m_scratch.data();
+  for (uint32_t pass = 0; pass < 8; ++pass) {
+    uint32_t *bucket = counts[pass];
+    // All keys share this byte (e.g. a single shader): nothing to reorder.
+    if (bucket[(src[0].key >> (pass * 8)) & 0xff] == count) {
+      continue;
+    }
+    uint32_t offset = 0;
+    for (uint32_t digit = 0; digit < 256; ++digit) {
+      const uint32_t digit_count = bucket[digit];
+      bucket[digit] = offset;
+      offset += digit_count;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      dst[bucket[(src[i].key >> (pass * 8)) & 0xff]++] = src[i];
+    }
+    std::swap(src, dst);
+  }
+  if (src != m_items.data()) {
+    m_items.swap(m_scratch);
+  }
+}
@@ -1,4 +1,7 @@
 #include "graphics/Shader.h"
+#include "graphics/FrameUniforms.h"
+#include "graphics/GLState.h"
+#include <algorithm>
 #include <fstream>
 #include <glad/glad.h>
 #include <iostream>
@@ -72,30 +75,43 @@ Shader::Shader(ShaderType type, const std::vector<std::string> &paths) {
 
     glDeleteShader(compute);
   }
+
+  reflect_uniforms();
+
+  // Hook the shared per-frame block up to its buffer, if the shader uses it.
+  const unsigned int frame_block =
+      glGetUniformBlockIndex(m_id, FrameUniforms::BLOCK_NAME);
+  if (frame_block != GL_INVALID_INDEX) {
+    glUniformBlockBinding(m_id, frame_block, FrameUniforms::BINDING);
+  }
 }
 
 Shader::~Shader() {
   if (m_id != 0) {
-    glDeleteProgram(m_id);
+    GLState::delete_program(m_id);
   }
 }
 
-Shader::Shader(Shader &&other) noexcept : m_id(other.m_id) {
+Shader::Shader(Shader &&other) noexcept
+    : m_id(other.m_id), m_uniforms(std::move(other.m_uniforms)),
+      m_reported_missing(std::move(other.m_reported_missing)) {
   other.m_id = 0; // Prevent the moved-from object from deleting the program
 }
 
 Shader &Shader::operator=(Shader &&other) noexcept {
   if (this != &other) {
     if (m_id != 0) {
-      glDeleteProgram(m_id);
+      GLState::delete_program(m_id);
     }
     m_id = other.m_id;
+    m_uniforms = std::move(other.m_uniforms);
+    m_reported_missing = std::move(other.m_reported_missing);
     other.m_id = 0;
   }
   return *this;
 }
 
-void Shader::use() const { glUseProgram(m_id); }
+void Shader::use() const { GLState::use_program(m_id); }
 
 void Shader::check_compile_errors(unsigned int shader,
                                   const std::string &type) {
@@ -124,47 +140,134 @@ void Shader::check_compile_errors(unsigned int shader,
   }
 }
 
-// Uniform location caching
-int Shader::get_uniform_location(const std::string &name) const {
-  // Check if we have already cached the location
-  if (m_uniform_location_cache.find(name) != m_uniform_location_cache.end()) {
-    return m_uniform_location_cache[name];
+// Uniform reflection
+void Shader::reflect_uniforms() {
+  m_uniforms.clear();
+  int count = 0;
+  glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &count);
+  int max_length = 0;
+  glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+  std::string name(static_cast<size_t>(std::max(max_length, 1)), '\0');
+
+  for (int i = 0; i < count; ++i) {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    glGetActiveUniform(m_id, static_cast<GLuint>(i),
+                       static_cast<GLsizei>(name.size()), &length, &size,
+                       &type, name.data());
+    std::string uniform_name = name.substr(0, static_cast<size_t>(length));
+    // Block members have no location; they're set through their buffer.
+    const int location = glGetUniformLocation(m_id, uniform_name.c_str());
+    if (location < 0) {
+      continue;
+    }
+    // Arrays are reported as "name[0]"; callers use the bare name.
+    if (uniform_name.size() > 3 &&
+        uniform_name.compare(uniform_name.size() - 3, 3, "[0]") == 0) {
+      uniform_name.resize(uniform_name.size() - 3);
+    }
+    const uint32_t hash = Hash::fnv1a(uniform_name);
+    m_uniforms.push_back({hash, location, std::move(uniform_name)});
+  }
+
+  std::sort(m_uniforms.begin(), m_uniforms.end(),
+            [](const UniformInfo &a, const UniformInfo &b) {
+              return a.hash < b.hash;
+            });
+}
+
+const Shader::UniformInfo *Shader::find_uniform(uint32_t hash,
+                                                std::string_view name) const {
+  auto it = std::lower_bound(
+      m_uniforms.begin(), m_uniforms.end(), hash,
+      [](const UniformInfo &info, uint32_t value) { return info.hash < value; });
+  // Compare names too, so a hash collision can't set the wrong uniform.
+  for (; it != m_uniforms.end() && it->hash == hash; ++it) {
+    if (it->name == name) {
+      return &*it;
+    }
+  }
+  return nullptr;
+}
+
+UniformHandle Shader::get_uniform(UniformName name) const {
+  const UniformInfo *info = find_uniform(name.hash, name.name);
+  return UniformHandle{info ? info->location : -1};
+}
+
+bool Shader::has_uniform(UniformName name) const {
+  return find_uniform(name.hash, name.name) != nullptr;
+}
+
+// Runtime-string lookup for the by-name setters. Misses warn once per name,
+// not once per call.
+UniformHandle Shader::get_uniform_checked(std::string_view name) const {
+  const uint32_t hash = Hash::fnv1a(name);
+  if (const UniformInfo *info = find_uniform(hash, name)) {
+    return UniformHandle{info->location};
   }
-  // If not, query OpenGL for the location
-  int location = glGetUniformLocation(m_id, name.c_str());
-  if (location == -1) {
+  if (std::find(m_reported_missing.begin(), m_reported_missing.end(), hash) ==
+      m_reported_missing.end()) {
+    m_reported_missing.push_back(hash);
     std::cerr << "Warning: uniform '" << name << "' not found!" << std::endl;
   }
-  // Cache the location for future use
-  m_uniform_location_cache[name] = location;
-  return location;
+  return UniformHandle{};
 }
 
 // Uniform setter functions
+void Shader::set_bool(UniformHandle handle, bool value) {
+  glUniform1i(handle.location, (int)value);
+}
+
+void Shader::set_int(UniformHandle handle, int value) {
+  glUniform1i(handle.location, value);
+}
+
+void Shader::set_float(UniformHandle handle, float value) {
+  glUniform1f(handle.location, value);
+}
+
+void Shader::set_vec2(UniformHandle handle, const glm::vec2 &value) {
+  glUniform2fv(handle.location, 1, &value[0]);
+}
+
+void Shader::set_vec3(UniformHandle handle, const glm::vec3 &value) {
+  glUniform3fv(handle.location, 1, &value[0]);
+}
+
+void Shader::set_vec4(UniformHandle handle, const glm::vec4 &value) {
+  glUniform4fv(handle.location, 1, &value[0]);
+}
+
+void Shader::set_mat4(UniformHandle handle, const glm::mat4 &mat) {
+  glUniformMatrix4fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+}
+
 void Shader::set_bool(const std::string &name, bool value) {
-  glUniform1i(get_uniform_location(name), (int)value);
+  set_bool(get_uniform_checked(name), value);
 }
 
 void Shader::set_int(const std::string &name, int value) {
-  glUniform1i(get_uniform_location(name), value);
+  set_int(get_uniform_checked(name), value);
 }
 
 void Shader::set_float(const std::string &name, float value) {
-  glUniform1f(get_uniform_location(name), value);
+  set_float(get_uniform_checked(name), value);
 }
 
 void Shader::set_vec2(const std::string &name, const glm::vec2 &value) {
-  glUniform2fv(get_uniform_location(name), 1, &value[0]);
+  set_vec2(get_uniform_checked(name), value);
 }
 
 void Shader::set_vec3(const std::string &name, const glm::vec3 &value) {
-  glUniform3fv(get_uniform_location(name), 1, &value[0]);
+  set_vec3(get_uniform_checked(name), value);
 }
 
 void Shader::set_vec4(const std::string &name, const glm::vec4 &value) {
-  glUniform4fv(get_uniform_location(name), 1, &value[0]);
+  set_vec4(get_uniform_checked(name), value);
 }
 
 void Shader::set_mat4(const std::string &name, const glm::mat4 &mat) {
-  glUniformMatrix4fv(get_uniform_location(name), 1, GL_FALSE, &mat[0][0]);
+  set_mat4(get_uniform_checked(name), mat);
 }
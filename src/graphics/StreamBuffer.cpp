@@ -0,0 +1,141 @@
+#include "graphics/StreamBuffer.h"
+#include "utils/Log.h"
+#include <glad/glad.h>
+#include <string>
+
+namespace {
+constexpr GLbitfield STORAGE_FLAGS =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+// Regions start on this boundary so any allocation alignment up to it holds
+// across regions.
+constexpr size_t REGION_ALIGNMENT = 256;
+
+// How long one glClientWaitSync call blocks before we check again.
+constexpr GLuint64 FENCE_WAIT_NS = 1000000; // 1 ms
+
+size_t align_up(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+bool StreamBuffer::is_supported() { return GLAD_GL_VERSION_4_4 != 0; }
+
+StreamBuffer::~StreamBuffer() { destroy(); }
+
+bool StreamBuffer::init(size_t frame_capacity) {
+  destroy();
+  if (!is_supported()) {
+    Log::warn("StreamBuffer: persistent mapping needs OpenGL 4.4.");
+    return false;
+  }
+  return create(frame_capacity);
+}
+
+bool StreamBuffer::create(size_t frame_capacity) {
+  m_frame_capacity = align_up(frame_capacity > 0 ? frame_capacity : 1,
+                              REGION_ALIGNMENT);
+  const size_t total = m_frame_capacity * FRAMES_IN_FLIGHT;
+
+  // Create through the copy target so no binding the renderer uses changes.
+  glGenBuffers(1, &m_buffer);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+  glBufferStorage(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(total),
+                  nullptr, STORAGE_FLAGS);
+  m_mapped = static_cast<unsigned char *>(glMapBufferRange(
+      GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(total), STORAGE_FLAGS));
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  if (!m_mapped) {
+    Log::error("StreamBuffer: failed to map " + std::to_string(total) +
+               " bytes.");
+    destroy();
+    return false;
+  }
+  m_cursor = 0;
+  return true;
+}
+
+void StreamBuffer::destroy() {
+  for (unsigned int region = 0; region < FRAMES_IN_FLIGHT; ++region) {
+    if (m_fences[region]) {
+      glDeleteSync(static_cast<GLsync>(m_fences[region]));
+      m_fences[region] = nullptr;
+    }
+  }
+  if (m_buffer != 0) {
+    // Deleting a mapped buffer unmaps it. The driver keeps the storage alive
+    // until draws already submitted from it have finished.
+    glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+  }
+  m_mapped = nullptr;
+  m_frame_capacity = 0;
+  m_cursor = 0;
+}
+
+void StreamBuffer::wait_for_region(unsigned int region) {
+  GLsync fence = static_cast<GLsync>(m_fences[region]);
+  if (!fence) {
+    return;
+  }
+  // Flush on the first wait so the fence is guaranteed to reach the GPU.
+  GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+  for (;;) {
+    const GLenum result = glClientWaitSync(fence, flags, FENCE_WAIT_NS);
+    if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+      break;
+    }
+    if (result == GL_WAIT_FAILED) {
+      Log::error("StreamBuffer: waiting for a frame fence failed.");
+      break;
+    }
+    flags = 0;
+  }
+  glDeleteSync(fence);
+  m_fences[region] = nullptr;
+}
+
+void StreamBuffer::begin_frame() {
+  m_region = (m_region + 1) % FRAMES_IN_FLIGHT;
+  m_cursor = 0;
+  wait_for_region(m_region);
+}
+
+bool StreamBuffer::reserve(size_t frame_capacity) {
+  if (frame_capacity <= m_frame_capacity) {
+    return m_mapped != nullptr;
+  }
+  // Grow geometrically so a slowly growing workload recreates rarely. The
+  // other regions' fences guard the old buffer, which the driver keeps alive
+  // on its own, so drop them.
+  size_t capacity = m_frame_capacity * 2;
+  if (capacity < frame_capacity) {
+    capacity = frame_capacity;
+  }
+  destroy();
+  return create(capacity);
+}
+
+StreamBuffer::Allocation StreamBuffer::allocate(size_t size,
+                                                size_t alignment) {
+  const size_t start = align_up(m_cursor, alignment);
+  if (!m_mapped || start + size > m_frame_capacity) {
+    return Allocation{};
+  }
+  m_cursor = start + size;
+  const size_t offset = m_region * m_frame_capacity + start;
+  return Allocation{m_mapped + offset, offset, size};
+}
+
+void StreamBuffer::end_frame() {
+  if (!m_mapped) {
+    return;
+  }
+  // A region fenced twice (end_frame without begin_frame) keeps the later
+  // fence.
+  if (m_fences[m_region]) {
+    glDeleteSync(static_cast<GLsync>(m_fences[m_region]));
+  }
+  m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -1,4 +1,5 @@
 #include "graphics/Texture.h"
+#include "graphics/GLState.h"
 #include <glad/glad.h>
 #include <iostream>
 #include <utility>
@@ -32,7 +33,7 @@ Texture::Texture(const std::string &path) : m_file_path(path) {
     }
 
     glGenTextures(1, &m_id);
-    glBindTexture(GL_TEXTURE_2D, m_id);
+    GLState::bind_texture(0, m_id);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
                     GL_LINEAR_MIPMAP_LINEAR);
@@ -53,7 +54,7 @@ Texture::Texture(const std::string &path) : m_file_path(path) {
 
 Texture::~Texture() {
   if (m_id != 0) {
-    glDeleteTextures(1, &m_id);
+    GLState::delete_texture(m_id);
   }
 }
 
@@ -67,7 +68,7 @@ Texture::Texture(Texture &&other) noexcept
 Texture &Texture::operator=(Texture &&other) noexcept {
   if (this != &other) {
     if (m_id != 0) {
-      glDeleteTextures(1, &m_id);
+      GLState::delete_texture(m_id);
     }
     m_id = other.m_id;
     m_file_path = std::move(other.m_file_path);
@@ -80,8 +81,9 @@ Texture &Texture::operator=(Texture &&other) noexcept {
 }
 
 void Texture::bind(unsigned int slot) const {
-  glActiveTexture(GL_TEXTURE0 + slot);
-  glBindTexture(GL_TEXTURE_2D, m_id);
+  GLState::bind_texture(slot, m_id);
 }
 
-void Texture::unbind() const { glBindTexture(GL_TEXTURE_2D, 0); }
+void Texture::unbind(unsigned int slot) const {
+  GLState::bind_texture(slot, 0);
+}
@@ -1,5 +1,6 @@
 #include "graphics/renderers/CanvasRenderer.h"
 #include "core/Settings.h"
+#include "graphics/GpuProfiler.h"
 #include "utils/Log.h"
 #include "utils/ResourceManager.h"
 #include <glad/glad.h>
@@ -41,6 +42,7 @@ void CanvasRenderer::update(float delta_time) {
 
 void CanvasRenderer::draw(Scene &scene, unsigned int screen_width,
                           unsigned int screen_height) {
+  GpuProfiler::Scope pass("canvas");
   // Always clear the color buffer.
   glClear(GL_COLOR_BUFFER_BIT);
 
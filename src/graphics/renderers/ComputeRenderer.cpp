@@ -1,6 +1,7 @@
 #include "graphics/renderers/ComputeRenderer.h"
 #include "core/Settings.h"
-#include "core/Time.h"
+#include "graphics/GLState.h"
+#include "graphics/GpuProfiler.h"
 #include "utils/Log.h"
 #include "utils/ResourceManager.h"
 #include <glad/glad.h>
@@ -8,7 +9,7 @@
 ComputeRenderer::ComputeRenderer() = default;
 ComputeRenderer::~ComputeRenderer() {
   if (m_texture_id != 0) {
-    glDeleteTextures(1, &m_texture_id);
+    GLState::delete_texture(m_texture_id);
   }
 }
 
@@ -34,26 +35,25 @@ bool ComputeRenderer::init(const Config &config) {
 
 void ComputeRenderer::create_texture(unsigned int width, unsigned int height) {
   if (m_texture_id != 0) {
-    glDeleteTextures(1, &m_texture_id);
+    GLState::delete_texture(m_texture_id);
   }
 
   m_texture_width = width;
   m_texture_height = height;
 
   glGenTextures(1, &m_texture_id);
-  glBindTexture(GL_TEXTURE_2D, m_texture_id);
+  GLState::bind_texture(0, m_texture_id);
   // Use RGBA32F for high precision color values
   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, m_texture_width, m_texture_height,
                0, GL_RGBA, GL_FLOAT, NULL);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void ComputeRenderer::update(float delta_time) {
+  GpuProfiler::Scope pass("compute");
   // 1. Use the compute shader
   m_compute_shader->use();
-  m_compute_shader->set_float("u_time", Time::get_total_time());
 
   // 2. Bind the texture as an image for writing
   // The first '0' is the image unit, which corresponds to 'layout(binding=0,
@@ -79,6 +79,7 @@ void ComputeRenderer::draw(Scene &scene, unsigned int screen_width,
     create_texture(screen_width, screen_height);
   }
 
+  GpuProfiler::Scope pass("present");
   glClear(GL_COLOR_BUFFER_BIT);
   glDisable(GL_DEPTH_TEST);
 
@@ -87,8 +88,7 @@ void ComputeRenderer::draw(Scene &scene, unsigned int screen_width,
   // m_draw_shader->set_int("u_texture", 0); // NOTE: This is not needed
 
   // Bind the texture generated by the compute shader for reading
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, m_texture_id);
+  GLState::bind_texture(0, m_texture_id);
 
   m_quad_mesh->draw(*m_draw_shader);
 }
@@ -1,15 +1,25 @@
 #include "graphics/renderers/GraphicsRenderer.h"
 #include "core/Settings.h"
+#include "graphics/FrameUniforms.h"
+#include "graphics/GpuProfiler.h"
+#include "graphics/Mesh.h"
 #include "scene/CameraComponent.h"
 #include "scene/Scene.h"
 #include "utils/Log.h"
 #include "utils/ResourceManager.h"
 #include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <glm/gtc/matrix_transform.hpp>
 #include <sstream>
 
 GraphicsRenderer::GraphicsRenderer() = default;
-GraphicsRenderer::~GraphicsRenderer() = default;
+GraphicsRenderer::~GraphicsRenderer() {
+  if (m_instance_vbo != 0) {
+    glDeleteBuffers(1, &m_instance_vbo);
+  }
+}
 
 bool GraphicsRenderer::init(const Config &config) {
   glEnable(GL_DEPTH_TEST);
@@ -38,6 +48,26 @@ bool GraphicsRenderer::init(const Config &config) {
     return false;
   }
 
+  if (config.graphics_gpu_driven) {
+    m_indirect_ready = m_indirect_pass.init(
+        ResourceManager::get_shader(config.graphics_cull_shader_name));
+    if (m_indirect_ready) {
+      m_gpu_driven = true;
+      Log::info("GPU-driven rendering enabled.");
+    } else {
+      Log::warn("GPU-driven rendering unavailable; culling on the CPU.");
+    }
+  }
+
+  // Stream instance data through a persistently mapped ring when the driver
+  // allows it; otherwise orphan a regular buffer every frame.
+  m_use_instance_stream =
+      StreamBuffer::is_supported() &&
+      m_instance_stream.init(INITIAL_INSTANCE_CAPACITY * sizeof(glm::mat4));
+  if (!m_use_instance_stream) {
+    glGenBuffers(1, &m_instance_vbo);
+  }
+
   Log::info("Renderer initialized successfully.");
   return true;
 }
@@ -50,11 +80,14 @@ void GraphicsRenderer::draw(Scene &scene, unsigned int screen_width,
                             unsigned int screen_height) {
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  glDepthMask(GL_FALSE);
-  m_canvas_shader->use();
-  m_canvas_quad_mesh->draw(*m_canvas_shader);
-  // Re-enable depth writing for the main scene.
-  glDepthMask(GL_TRUE);
+  {
+    GpuProfiler::Scope pass("canvas");
+    glDepthMask(GL_FALSE);
+    m_canvas_shader->use();
+    m_canvas_quad_mesh->draw(*m_canvas_shader);
+    // Re-enable depth writing for the main scene.
+    glDepthMask(GL_TRUE);
+  }
 
   auto camera_object = scene.get_active_camera();
   // TODO: Is there a way to skip having to check if camera_object exists? Does
@@ -79,16 +112,139 @@ void GraphicsRenderer::draw(Scene &scene, unsigned int screen_width,
       static_cast<float>(screen_width) / static_cast<float>(screen_height);
   glm::mat4 projection = camera_comp->get_projection_matrix(aspect_ratio);
 
-  m_shader->set_mat4("projection", projection);
-  m_shader->set_mat4("view", view);
+  FrameUniforms::set_camera(view, projection);
+
+  const Frustum frustum = Frustum::from_matrix(projection * view);
+  GpuProfiler::Scope pass("scene");
+  if (m_gpu_driven) {
+    m_indirect_pass.draw(scene, frustum, *m_shader);
+    return;
+  }
+
+  // One draw call per unique mesh instead of one per object, skipping
+  // objects outside the view.
+  build_batches(scene, frustum, view);
+  const InstanceSource source = upload_instances();
+  for (const auto &item : m_queue.items()) {
+    const auto &batch = m_batches[item.payload];
+    batch.mesh->draw_instanced(*m_shader, source.buffer, batch.instance_count,
+                               source.base_instance + batch.first_instance);
+  }
+  if (m_use_instance_stream) {
+    m_instance_stream.end_frame();
+  }
+}
+
+void GraphicsRenderer::build_batches(const Scene &scene,
+                                     const Frustum &frustum,
+                                     const glm::mat4 &view) {
+  const World &world = scene.get_world();
+  const TransformStore &transforms = scene.get_transform_store();
+
+  m_batches.clear();
+  m_batch_lookup.clear();
+  m_object_batch.clear();
+  m_visible.clear();
 
-  for (const auto &object : scene.get_scene_objects()) {
-    // Only draw objects that have a mesh component
-    if (object->mesh) {
-      m_shader->set_mat4("model", object->transform->get_transform_matrix());
-      object->mesh->draw(*m_shader);
+  // 1. Find the visible mesh objects through the scene's BVH, assign each to
+  // a batch and count the batch sizes.
+  scene.get_spatial_index().query_frustum(frustum, m_visible);
+  m_object_batch.reserve(m_visible.size());
+  for (Entity entity : m_visible) {
+    Mesh *mesh = world.get<MeshRef>(entity)->mesh.get();
+    auto [it, inserted] = m_batch_lookup.try_emplace(
+        mesh, static_cast<unsigned int>(m_batches.size()));
+    if (inserted) {
+      m_batches.push_back({mesh, 0, 0});
     }
+    m_batches[it->second].instance_count++;
+    m_object_batch.push_back(it->second);
   }
+
+  // 2. Turn the counts into offsets so each batch is a contiguous range.
+  unsigned int offset = 0;
+  for (auto &batch : m_batches) {
+    batch.first_instance = offset;
+    offset += batch.instance_count;
+    batch.instance_count = 0; // Reused as the write cursor below
+    batch.depth = std::numeric_limits<float>::max();
+  }
+
+  // 3. Scatter the model matrices into their batch's range, tracking each
+  // batch's nearest instance. The camera looks down -z in view space.
+  m_instance_matrices.resize(offset);
+  const auto &world_matrices = transforms.render_matrices();
+  const glm::vec4 view_z_row(view[0][2], view[1][2], view[2][2], view[3][2]);
+  for (size_t i = 0; i < m_visible.size(); ++i) {
+    const TransformLink *link = world.get<TransformLink>(m_visible[i]);
+    auto &batch = m_batches[m_object_batch[i]];
+    const glm::mat4 &model =
+        world_matrices[transforms.dense_index(link->handle)];
+    m_instance_matrices[batch.first_instance + batch.instance_count++] = model;
+    batch.depth = std::min(batch.depth, -glm::dot(view_z_row, model[3]));
+  }
+
+  // 4. Order the batches so shader and texture changes are grouped, meshes
+  // follow each other in arena order and same-state batches draw front to
+  // back.
+  m_queue.clear();
+  const unsigned int shader = m_shader->get_id();
+  for (size_t i = 0; i < m_batches.size(); ++i) {
+    const auto &batch = m_batches[i];
+    m_queue.push(RenderQueue::make_key(shader, batch.mesh->get_texture_id(),
+                                       batch.mesh->get_geometry().first_index,
+                                       batch.depth),
+                 static_cast<uint32_t>(i));
+  }
+  m_queue.sort();
+}
+
+GraphicsRenderer::InstanceSource GraphicsRenderer::upload_instances() {
+  if (m_use_instance_stream) {
+    const size_t bytes = m_instance_matrices.size() * sizeof(glm::mat4);
+    m_instance_stream.begin_frame();
+    if (m_instance_stream.reserve(bytes)) {
+      // Matrix-aligned, so the byte offset is a whole number of instances.
+      const auto allocation =
+          m_instance_stream.allocate(bytes, sizeof(glm::mat4));
+      if (allocation.data) {
+        if (bytes > 0) {
+          std::memcpy(allocation.data, m_instance_matrices.data(), bytes);
+        }
+        return {m_instance_stream.get_id(),
+                static_cast<unsigned int>(allocation.offset /
+                                          sizeof(glm::mat4))};
+      }
+    }
+    // Growing the ring failed: orphan a regular buffer from now on.
+    Log::warn("Instance stream unavailable; falling back to buffer "
+              "orphaning.");
+    m_use_instance_stream = false;
+    if (m_instance_vbo == 0) {
+      glGenBuffers(1, &m_instance_vbo);
+    }
+  }
+
+  if (m_instance_matrices.empty()) {
+    return {m_instance_vbo, 0};
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
+  if (m_instance_matrices.size() > m_instance_capacity) {
+    // Grow geometrically so a slowly growing scene doesn't reallocate every
+    // frame.
+    m_instance_capacity =
+        std::max(m_instance_matrices.size(), m_instance_capacity * 2);
+  }
+  // Orphan the previous contents so the driver doesn't have to wait for last
+  // frame's draws before we overwrite them.
+  glBufferData(GL_ARRAY_BUFFER, m_instance_capacity * sizeof(glm::mat4),
+               nullptr, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0,
+                  m_instance_matrices.size() * sizeof(glm::mat4),
+                  m_instance_matrices.data());
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return {m_instance_vbo, 0};
 }
 
 void GraphicsRenderer::execute_command(const std::string &command_line) {
@@ -110,6 +266,18 @@ void GraphicsRenderer::execute_command(const std::string &command_line) {
     } else {
       Log::warn("Command 'set_canvas_shader' requires a shader name argument.");
     }
+  } else if (command == "set_gpu_driven") {
+    std::string value;
+    ss >> value;
+    const bool enable = value == "on" || value == "1" || value == "true";
+    if (enable && !m_indirect_ready) {
+      Log::warn("GPU-driven rendering was not initialized; enable "
+                "graphics_gpu_driven in the runtime settings.");
+    } else {
+      m_gpu_driven = enable;
+      Log::info(std::string("GPU-driven rendering ") +
+                (enable ? "enabled." : "disabled."));
+    }
   }
   // Future extensibility example:
   // else if (command == "set_clear_color") {
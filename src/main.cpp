@@ -1,9 +1,11 @@
 #include "core/Application.h"
 #include <iostream>
+#include <string>
+#include <vector>
 
-int main() {
+int main(int argc, char **argv) {
   try {
-    Application app;
+    Application app(std::vector<std::string>(argv + 1, argv + argc));
     app.run();
   } catch (const std::exception &e) {
     std::cerr << "An exception occurred: " << e.what() << std::endl;
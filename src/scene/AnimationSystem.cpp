@@ -0,0 +1,319 @@
+#include "scene/AnimationSystem.h"
+#include "core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr uint32_t INVALID = TransformHandle::INVALID_INDEX;
+constexpr float TWO_PI = 6.28318530718f;
+
+template <typename T> void swap_remove(std::vector<T> &values, size_t index) {
+  values[index] = values.back();
+  values.pop_back();
+}
+
+// Evaluates sin(2 * pi * turns[i]) for a whole batch. The phase is folded
+// into a quarter wave and fed to an odd Taylor polynomial (error below 4e-6).
+// The loop has no branches or calls, so the compiler can vectorize it.
+void sin_turns(const float *turns, float *out, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    float r = turns[i] - std::floor(turns[i] + 0.5f); // [-0.5, 0.5)
+    float a = std::fabs(r);
+    float folded = std::fmin(a, 0.5f - a); // [0, 0.25]
+    float x = std::copysign(folded, r) * TWO_PI;
+    float x2 = x * x;
+    out[i] =
+        x * (1.0f +
+             x2 * (-1.0f / 6.0f +
+                   x2 * (1.0f / 120.0f +
+                         x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f)))));
+  }
+}
+
+// Reduces total_time * rate to a fraction of a turn in double precision, so
+// long uptimes don't eat into the float mantissa.
+void phases(double total_time, const float *turns_per_second, float *out,
+            size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    double turns = total_time * turns_per_second[i];
+    out[i] = static_cast<float>(turns - std::floor(turns));
+  }
+}
+} // namespace
+
+// --- TrackIndex ---
+
+uint32_t AnimationSystem::TrackIndex::add() {
+  uint32_t id;
+  if (!free_ids.empty()) {
+    id = free_ids.back();
+    free_ids.pop_back();
+  } else {
+    id = static_cast<uint32_t>(id_to_dense.size());
+    id_to_dense.push_back(0);
+  }
+  id_to_dense[id] = static_cast<uint32_t>(dense_to_id.size());
+  dense_to_id.push_back(id);
+  return id;
+}
+
+uint32_t AnimationSystem::TrackIndex::remove(uint32_t id) {
+  uint32_t dense = id_to_dense[id];
+  dense_to_id[dense] = dense_to_id.back();
+  id_to_dense[dense_to_id[dense]] = dense;
+  dense_to_id.pop_back();
+  free_ids.push_back(id);
+  return dense;
+}
+
+// --- Registration ---
+
+AnimationSystem::TrackId
+AnimationSystem::add_rotation(TransformHandle target, const glm::vec3 &axis,
+                              float degrees_per_second) {
+  auto &tracks = m_rotations;
+  uint32_t id = tracks.index.add();
+  tracks.targets.handles.push_back(target);
+  tracks.targets.dense.push_back(INVALID);
+  glm::vec3 unit_axis = glm::normalize(axis);
+  tracks.axis_x.push_back(unit_axis.x);
+  tracks.axis_y.push_back(unit_axis.y);
+  tracks.axis_z.push_back(unit_axis.z);
+  // A quaternion rotates by twice its half-angle.
+  tracks.turns_per_second.push_back(degrees_per_second / 720.0f);
+  m_cached_store = nullptr; // Resolve the new target on the next update
+  return TrackId{Kind::Rotation, id};
+}
+
+AnimationSystem::TrackId
+AnimationSystem::add_position(TransformHandle target, const glm::vec3 &origin,
+                              const glm::vec3 &direction, float speed,
+                              float distance) {
+  auto &tracks = m_positions;
+  uint32_t id = tracks.index.add();
+  tracks.targets.handles.push_back(target);
+  tracks.targets.dense.push_back(INVALID);
+  tracks.origin_x.push_back(origin.x);
+  tracks.origin_y.push_back(origin.y);
+  tracks.origin_z.push_back(origin.z);
+  tracks.direction_x.push_back(direction.x);
+  tracks.direction_y.push_back(direction.y);
+  tracks.direction_z.push_back(direction.z);
+  tracks.turns_per_second.push_back(speed / TWO_PI);
+  tracks.distance.push_back(distance);
+  m_cached_store = nullptr;
+  return TrackId{Kind::Position, id};
+}
+
+AnimationSystem::TrackId
+AnimationSystem::add_scale(TransformHandle target, const glm::vec3 &base_scale,
+                           float speed, float min_scale, float max_scale) {
+  auto &tracks = m_scales;
+  uint32_t id = tracks.index.add();
+  tracks.targets.handles.push_back(target);
+  tracks.targets.dense.push_back(INVALID);
+  tracks.base_x.push_back(base_scale.x);
+  tracks.base_y.push_back(base_scale.y);
+  tracks.base_z.push_back(base_scale.z);
+  tracks.turns_per_second.push_back(speed / TWO_PI);
+  tracks.min_scale.push_back(min_scale);
+  tracks.half_range.push_back((max_scale - min_scale) * 0.5f);
+  m_cached_store = nullptr;
+  return TrackId{Kind::Scale, id};
+}
+
+void AnimationSystem::remove(TrackId track) {
+  if (!track.is_valid()) {
+    return;
+  }
+  switch (track.kind) {
+  case Kind::Rotation: {
+    auto &tracks = m_rotations;
+    uint32_t dense = tracks.index.remove(track.id);
+    swap_remove(tracks.targets.handles, dense);
+    swap_remove(tracks.targets.dense, dense);
+    swap_remove(tracks.axis_x, dense);
+    swap_remove(tracks.axis_y, dense);
+    swap_remove(tracks.axis_z, dense);
+    swap_remove(tracks.turns_per_second, dense);
+    break;
+  }
+  case Kind::Position: {
+    auto &tracks = m_positions;
+    uint32_t dense = tracks.index.remove(track.id);
+    swap_remove(tracks.targets.handles, dense);
+    swap_remove(tracks.targets.dense, dense);
+    swap_remove(tracks.origin_x, dense);
+    swap_remove(tracks.origin_y, dense);
+    swap_remove(tracks.origin_z, dense);
+    swap_remove(tracks.direction_x, dense);
+    swap_remove(tracks.direction_y, dense);
+    swap_remove(tracks.direction_z, dense);
+    swap_remove(tracks.turns_per_second, dense);
+    swap_remove(tracks.distance, dense);
+    break;
+  }
+  case Kind::Scale: {
+    auto &tracks = m_scales;
+    uint32_t dense = tracks.index.remove(track.id);
+    swap_remove(tracks.targets.handles, dense);
+    swap_remove(tracks.targets.dense, dense);
+    swap_remove(tracks.base_x, dense);
+    swap_remove(tracks.base_y, dense);
+    swap_remove(tracks.base_z, dense);
+    swap_remove(tracks.turns_per_second, dense);
+    swap_remove(tracks.min_scale, dense);
+    swap_remove(tracks.half_range, dense);
+    break;
+  }
+  }
+}
+
+size_t AnimationSystem::size() const {
+  return m_rotations.targets.handles.size() +
+         m_positions.targets.handles.size() + m_scales.targets.handles.size();
+}
+
+// --- Evaluation ---
+
+void AnimationSystem::update(TransformStore &transforms, float delta_time,
+                             double total_time) {
+  if (m_cached_store != &transforms ||
+      m_cached_layout_version != transforms.get_layout_version()) {
+    refresh_targets(transforms);
+  }
+
+  size_t largest = m_rotations.targets.dense.size();
+  largest = std::max(largest, m_positions.targets.dense.size());
+  largest = std::max(largest, m_scales.targets.dense.size());
+  m_phase.resize(largest);
+  m_sin.resize(largest);
+  m_cos.resize(largest);
+
+  // Kinds run one after another, so an object with several animators gets
+  // them applied in a fixed order: rotation, position, scale.
+  update_rotations(transforms, delta_time);
+  update_positions(transforms, total_time);
+  update_scales(transforms, total_time);
+}
+
+void AnimationSystem::refresh_targets(const TransformStore &transforms) {
+  std::vector<uint32_t> sorted;
+  for (Targets *targets :
+       {&m_rotations.targets, &m_positions.targets, &m_scales.targets}) {
+    const size_t count = targets->handles.size();
+    sorted.clear();
+    for (size_t i = 0; i < count; ++i) {
+      TransformHandle handle = targets->handles[i];
+      targets->dense[i] = transforms.is_alive(handle)
+                              ? transforms.dense_index(handle)
+                              : INVALID;
+      if (targets->dense[i] != INVALID) {
+        sorted.push_back(targets->dense[i]);
+      }
+    }
+    std::sort(sorted.begin(), sorted.end());
+    targets->unique =
+        std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+  }
+  m_cached_store = &transforms;
+  m_cached_layout_version = transforms.get_layout_version();
+}
+
+template <typename Func>
+void AnimationSystem::run_tracks(const Targets &targets, Func &&body) {
+  const size_t count = targets.dense.size();
+  if (targets.unique) {
+    JobSystem::parallel_for(count, TRACK_CHUNK_SIZE, body);
+  } else {
+    body(size_t(0), count);
+  }
+}
+
+void AnimationSystem::update_rotations(TransformStore &transforms,
+                                       float delta_time) {
+  auto &tracks = m_rotations;
+  auto &rotations = transforms.rotations();
+  run_tracks(tracks.targets, [&](size_t begin, size_t end) {
+    // 1. Half-angle of this frame's rotation, then its sine and cosine.
+    for (size_t i = begin; i < end; ++i) {
+      m_phase[i] = tracks.turns_per_second[i] * delta_time;
+    }
+    sin_turns(m_phase.data() + begin, m_sin.data() + begin, end - begin);
+    for (size_t i = begin; i < end; ++i) {
+      m_phase[i] += 0.25f; // cos(x) = sin(x + quarter turn)
+    }
+    sin_turns(m_phase.data() + begin, m_cos.data() + begin, end - begin);
+
+    // 2. rotation = delta * rotation, with delta = (cos, axis * sin).
+    for (size_t i = begin; i < end; ++i) {
+      uint32_t dense = tracks.targets.dense[i];
+      if (dense == INVALID) {
+        continue;
+      }
+      const float dw = m_cos[i];
+      const float dx = tracks.axis_x[i] * m_sin[i];
+      const float dy = tracks.axis_y[i] * m_sin[i];
+      const float dz = tracks.axis_z[i] * m_sin[i];
+      const glm::quat q = rotations[dense];
+      glm::quat result(dw * q.w - dx * q.x - dy * q.y - dz * q.z,
+                       dw * q.x + dx * q.w + dy * q.z - dz * q.y,
+                       dw * q.y - dx * q.z + dy * q.w + dz * q.x,
+                       dw * q.z + dx * q.y - dy * q.x + dz * q.w);
+      // Renormalize so approximation error can't accumulate over time.
+      rotations[dense] = glm::normalize(result);
+      transforms.mark_dirty(dense);
+    }
+  });
+}
+
+void AnimationSystem::update_positions(TransformStore &transforms,
+                                       double total_time) {
+  auto &tracks = m_positions;
+  auto &positions = transforms.positions();
+  run_tracks(tracks.targets, [&](size_t begin, size_t end) {
+    const size_t count = end - begin;
+    phases(total_time, tracks.turns_per_second.data() + begin,
+           m_phase.data() + begin, count);
+    sin_turns(m_phase.data() + begin, m_sin.data() + begin, count);
+
+    for (size_t i = begin; i < end; ++i) {
+      uint32_t dense = tracks.targets.dense[i];
+      if (dense == INVALID) {
+        continue;
+      }
+      const float offset = m_sin[i] * tracks.distance[i];
+      positions[dense] =
+          glm::vec3(tracks.origin_x[i] + tracks.direction_x[i] * offset,
+                    tracks.origin_y[i] + tracks.direction_y[i] * offset,
+                    tracks.origin_z[i] + tracks.direction_z[i] * offset);
+      transforms.mark_dirty(dense);
+    }
+  });
+}
+
+void AnimationSystem::update_scales(TransformStore &transforms,
+                                    double total_time) {
+  auto &tracks = m_scales;
+  auto &scales = transforms.scales();
+  run_tracks(tracks.targets, [&](size_t begin, size_t end) {
+    const size_t count = end - begin;
+    phases(total_time, tracks.turns_per_second.data() + begin,
+           m_phase.data() + begin, count);
+    sin_turns(m_phase.data() + begin, m_sin.data() + begin, count);
+
+    for (size_t i = begin; i < end; ++i) {
+      uint32_t dense = tracks.targets.dense[i];
+      if (dense == INVALID) {
+        continue;
+      }
+      // min + (sin + 1) / 2 * range
+      const float factor =
+          tracks.min_scale[i] + (m_sin[i] + 1.0f) * tracks.half_range[i];
+      scales[dense] = glm::vec3(tracks.base_x[i] * factor,
+                                tracks.base_y[i] * factor,
+                                tracks.base_z[i] * factor);
+      transforms.mark_dirty(dense);
+    }
+  });
+}
@@ -0,0 +1,405 @@
+#include "scene/Bvh.h"
+#include "scene/SceneObject.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+constexpr float INF = std::numeric_limits<float>::infinity();
+
+Aabb empty_box() { return Aabb{glm::vec3(INF), glm::vec3(-INF)}; }
+
+void grow(Aabb &box, const Aabb &other) {
+  box.min = glm::min(box.min, other.min);
+  box.max = glm::max(box.max, other.max);
+}
+
+bool overlaps(const Aabb &a, const Aabb &b) {
+  return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y &&
+         a.max.y >= b.min.y && a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+float distance_sq(const Aabb &box, const glm::vec3 &point) {
+  const glm::vec3 closest = glm::clamp(point, box.min, box.max);
+  const glm::vec3 offset = point - closest;
+  return glm::dot(offset, offset);
+}
+
+// Slab test. Returns the entry distance, or INF if the ray misses the box
+// within [0, max_distance].
+float ray_box(const Aabb &box, const glm::vec3 &origin,
+              const glm::vec3 &inv_direction, float max_distance) {
+  const glm::vec3 t0 = (box.min - origin) * inv_direction;
+  const glm::vec3 t1 = (box.max - origin) * inv_direction;
+  const glm::vec3 t_min = glm::min(t0, t1);
+  const glm::vec3 t_max = glm::max(t0, t1);
+  const float enter = std::max({t_min.x, t_min.y, t_min.z, 0.0f});
+  const float exit = std::min({t_max.x, t_max.y, t_max.z, max_distance});
+  return enter <= exit ? enter : INF;
+}
+} // namespace
+
+// --- Maintenance ---
+
+void Bvh::update(const World &world) {
+  if (&world != m_world ||
+      world.get_layout_version() != m_world_layout_version) {
+    // Different entities: gather them all and build from scratch.
+    m_entities.clear();
+    m_spheres.clear();
+    world.each<const WorldBounds>([this](Entity entity,
+                                         const WorldBounds &bounds) {
+      m_entities.push_back(entity);
+      m_spheres.push_back(bounds.sphere);
+    });
+    m_boxes.resize(m_spheres.size());
+    for (size_t i = 0; i < m_spheres.size(); ++i) {
+      m_boxes[i] = Aabb::from_sphere(m_spheres[i]);
+    }
+    m_source_to_prim.resize(m_entities.size());
+    for (uint32_t i = 0; i < m_source_to_prim.size(); ++i) {
+      m_source_to_prim[i] = i;
+    }
+    m_world = &world;
+    m_world_layout_version = world.get_layout_version();
+    rebuild();
+    return;
+  }
+
+  // Same entities in the same query order: copy the new bounds and refit.
+  size_t source = 0;
+  world.each_chunk<const WorldBounds>(
+      [this, &source](uint32_t count, const Entity *,
+                      const WorldBounds *bounds) {
+        for (uint32_t i = 0; i < count; ++i) {
+          const uint32_t prim = m_source_to_prim[source++];
+          m_spheres[prim] = bounds[i].sphere;
+          m_boxes[prim] = Aabb::from_sphere(bounds[i].sphere);
+        }
+      });
+  if (refit() > m_built_area * REBUILD_THRESHOLD) {
+    rebuild();
+  }
+}
+
+void Bvh::rebuild() {
+  const uint32_t count = static_cast<uint32_t>(m_entities.size());
+  m_nodes.clear();
+  if (count == 0) {
+    m_built_area = 0.0f;
+    return;
+  }
+
+  m_order.resize(count);
+  m_centroids.resize(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    m_order[i] = i;
+    m_centroids[i] = glm::vec3(m_spheres[i]);
+  }
+
+  // Top-down, splitting nodes off an explicit stack. Children are always
+  // appended after their parent, which refit() relies on.
+  Node root;
+  root.prim_count = count;
+  m_nodes.push_back(root);
+  std::vector<uint32_t> stack{0};
+  while (!stack.empty()) {
+    const uint32_t index = stack.back();
+    stack.pop_back();
+    if (split(index)) {
+      stack.push_back(m_nodes[index].left);
+      stack.push_back(m_nodes[index].left + 1);
+    }
+  }
+
+  // Store the primitives in leaf order and remap the query positions.
+  std::vector<Entity> entities(count);
+  std::vector<BoundingSphere> spheres(count);
+  std::vector<uint32_t> new_position(count);
+  for (uint32_t k = 0; k < count; ++k) {
+    entities[k] = m_entities[m_order[k]];
+    spheres[k] = m_spheres[m_order[k]];
+    new_position[m_order[k]] = k;
+  }
+  m_entities = std::move(entities);
+  m_spheres = std::move(spheres);
+  for (uint32_t k = 0; k < count; ++k) {
+    m_boxes[k] = Aabb::from_sphere(m_spheres[k]);
+  }
+  for (uint32_t &prim : m_source_to_prim) {
+    prim = new_position[prim];
+  }
+
+  m_built_area = refit();
+}
+
+bool Bvh::split(uint32_t node_index) {
+  // Copy: m_nodes may grow below.
+  const Node node = m_nodes[node_index];
+  if (node.prim_count <= MAX_LEAF_SIZE) {
+    return false;
+  }
+  const uint32_t begin = node.first_prim;
+  const uint32_t end = begin + node.prim_count;
+
+  Aabb centroid_bounds = empty_box();
+  for (uint32_t i = begin; i < end; ++i) {
+    const glm::vec3 &c = m_centroids[m_order[i]];
+    centroid_bounds.min = glm::min(centroid_bounds.min, c);
+    centroid_bounds.max = glm::max(centroid_bounds.max, c);
+  }
+
+  // Binned SAH: try BIN_COUNT - 1 planes per axis, keep the cheapest.
+  float best_cost = INF;
+  int best_axis = -1;
+  uint32_t best_plane = 0;
+  for (int axis = 0; axis < 3; ++axis) {
+    const float extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+    if (extent <= 0.0f) {
+      continue;
+    }
+    Aabb bin_bounds[BIN_COUNT];
+    uint32_t bin_counts[BIN_COUNT] = {};
+    for (Aabb &box : bin_bounds) {
+      box = empty_box();
+    }
+    const float scale = BIN_COUNT / extent;
+    for (uint32_t i = begin; i < end; ++i) {
+      const uint32_t prim = m_order[i];
+      const uint32_t bin = std::min(
+          BIN_COUNT - 1,
+          static_cast<uint32_t>((m_centroids[prim][axis] -
+                                 centroid_bounds.min[axis]) *
+                                scale));
+      bin_counts[bin]++;
+      grow(bin_bounds[bin], m_boxes[prim]);
+    }
+
+    // Sweep from both ends to get the area and count on each side of every
+    // plane.
+    float left_area[BIN_COUNT - 1];
+    uint32_t left_count[BIN_COUNT - 1];
+    Aabb left = empty_box();
+    uint32_t running = 0;
+    for (uint32_t plane = 0; plane < BIN_COUNT - 1; ++plane) {
+      grow(left, bin_bounds[plane]);
+      running += bin_counts[plane];
+      left_area[plane] = running ? left.half_area() : 0.0f;
+      left_count[plane] = running;
+    }
+    Aabb right = empty_box();
+    running = 0;
+    for (uint32_t plane = BIN_COUNT - 1; plane > 0; --plane) {
+      grow(right, bin_bounds[plane]);
+      running += bin_counts[plane];
+      const uint32_t lc = left_count[plane - 1];
+      if (lc == 0 || running == 0) {
+        continue;
+      }
+      const float cost =
+          lc * left_area[plane - 1] + running * right.half_area();
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_plane = plane;
+      }
+    }
+  }
+  if (best_axis < 0) {
+    // Every centroid coincides; nothing to split on.
+    return false;
+  }
+
+  const float scale =
+      BIN_COUNT /
+      (centroid_bounds.max[best_axis] - centroid_bounds.min[best_axis]);
+  const float min = centroid_bounds.min[best_axis];
+  auto middle = std::partition(
+      m_order.begin() + begin, m_order.begin() + end, [&](uint32_t prim) {
+        const uint32_t bin = std::min(
+            BIN_COUNT - 1,
+            static_cast<uint32_t>((m_centroids[prim][best_axis] - min) *
+                                  scale));
+        return bin < best_plane;
+      });
+  const uint32_t left_count =
+      static_cast<uint32_t>(middle - m_order.begin()) - begin;
+
+  Node left_node;
+  left_node.first_prim = begin;
+  left_node.prim_count = left_count;
+  Node right_node;
+  right_node.first_prim = begin + left_count;
+  right_node.prim_count = node.prim_count - left_count;
+  m_nodes[node_index].left = static_cast<uint32_t>(m_nodes.size());
+  m_nodes.push_back(left_node);
+  m_nodes.push_back(right_node);
+  return true;
+}
+
+float Bvh::refit() {
+  float total_area = 0.0f;
+  for (size_t i = m_nodes.size(); i-- > 0;) {
+    Node &node = m_nodes[i];
+    node.bounds = empty_box();
+    if (node.is_leaf()) {
+      for (uint32_t p = node.first_prim; p < node.first_prim + node.prim_count;
+           ++p) {
+        grow(node.bounds, m_boxes[p]);
+      }
+    } else {
+      grow(node.bounds, m_nodes[node.left].bounds);
+      grow(node.bounds, m_nodes[node.left + 1].bounds);
+    }
+    total_area += node.bounds.half_area();
+  }
+  return total_area;
+}
+
+// --- Queries ---
+
+void Bvh::query_frustum(const Frustum &frustum,
+                        std::vector<Entity> &out) const {
+  if (m_nodes.empty()) {
+    return;
+  }
+  uint8_t visible[MAX_LEAF_SIZE];
+  std::vector<uint32_t> stack{0};
+  while (!stack.empty()) {
+    const Node &node = m_nodes[stack.back()];
+    stack.pop_back();
+    const Frustum::Containment containment = frustum.test(node.bounds);
+    if (containment == Frustum::OUTSIDE) {
+      continue;
+    }
+    if (containment == Frustum::INSIDE) {
+      // The whole subtree is visible, and its primitives are contiguous.
+      out.insert(out.end(), m_entities.begin() + node.first_prim,
+                 m_entities.begin() + node.first_prim + node.prim_count);
+    } else if (node.is_leaf()) {
+      // Leaves that can reach here hold at most MAX_LEAF_SIZE primitives,
+      // except for piles of coincident ones.
+      for (uint32_t p = 0; p < node.prim_count; p += MAX_LEAF_SIZE) {
+        const uint32_t batch = std::min(MAX_LEAF_SIZE, node.prim_count - p);
+        frustum.cull_spheres(&m_spheres[node.first_prim + p], batch, visible);
+        for (uint32_t i = 0; i < batch; ++i) {
+          if (visible[i]) {
+            out.push_back(m_entities[node.first_prim + p + i]);
+          }
+        }
+      }
+    } else {
+      stack.push_back(node.left);
+      stack.push_back(node.left + 1);
+    }
+  }
+}
+
+void Bvh::query_sphere(const glm::vec3 &center, float radius,
+                       std::vector<Entity> &out) const {
+  if (m_nodes.empty()) {
+    return;
+  }
+  const float radius_sq = radius * radius;
+  std::vector<uint32_t> stack{0};
+  while (!stack.empty()) {
+    const Node &node = m_nodes[stack.back()];
+    stack.pop_back();
+    if (distance_sq(node.bounds, center) > radius_sq) {
+      continue;
+    }
+    if (!node.is_leaf()) {
+      stack.push_back(node.left);
+      stack.push_back(node.left + 1);
+      continue;
+    }
+    for (uint32_t p = node.first_prim; p < node.first_prim + node.prim_count;
+         ++p) {
+      const glm::vec3 offset = glm::vec3(m_spheres[p]) - center;
+      const float reach = radius + m_spheres[p].w;
+      if (glm::dot(offset, offset) <= reach * reach) {
+        out.push_back(m_entities[p]);
+      }
+    }
+  }
+}
+
+void Bvh::query_box(const Aabb &box, std::vector<Entity> &out) const {
+  if (m_nodes.empty()) {
+    return;
+  }
+  std::vector<uint32_t> stack{0};
+  while (!stack.empty()) {
+    const Node &node = m_nodes[stack.back()];
+    stack.pop_back();
+    if (!overlaps(node.bounds, box)) {
+      continue;
+    }
+    if (!node.is_leaf()) {
+      stack.push_back(node.left);
+      stack.push_back(node.left + 1);
+      continue;
+    }
+    for (uint32_t p = node.first_prim; p < node.first_prim + node.prim_count;
+         ++p) {
+      if (overlaps(m_boxes[p], box)) {
+        out.push_back(m_entities[p]);
+      }
+    }
+  }
+}
+
+bool Bvh::raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+                  float max_distance, RayHit &hit) const {
+  if (m_nodes.empty()) {
+    return false;
+  }
+  // Division by a zero component yields +-INF, which the slab test handles.
+  const glm::vec3 inv_direction = glm::vec3(1.0f) / direction;
+  float best = max_distance;
+  bool found = false;
+
+  std::vector<uint32_t> stack{0};
+  while (!stack.empty()) {
+    const Node &node = m_nodes[stack.back()];
+    stack.pop_back();
+    if (ray_box(node.bounds, origin, inv_direction, best) == INF) {
+      continue;
+    }
+    if (!node.is_leaf()) {
+      // Visit the nearer child first so `best` shrinks sooner.
+      const float left = ray_box(m_nodes[node.left].bounds, origin,
+                                 inv_direction, best);
+      const float right = ray_box(m_nodes[node.left + 1].bounds, origin,
+                                  inv_direction, best);
+      if (left <= right) {
+        stack.push_back(node.left + 1);
+        stack.push_back(node.left);
+      } else {
+        stack.push_back(node.left);
+        stack.push_back(node.left + 1);
+      }
+      continue;
+    }
+    for (uint32_t p = node.first_prim; p < node.first_prim + node.prim_count;
+         ++p) {
+      // Ray/sphere: solve |origin + t * direction - center| = radius.
+      const glm::vec3 offset = origin - glm::vec3(m_spheres[p]);
+      const float b = glm::dot(offset, direction);
+      const float c =
+          glm::dot(offset, offset) - m_spheres[p].w * m_spheres[p].w;
+      const float discriminant = b * b - c;
+      if (discriminant < 0.0f) {
+        continue;
+      }
+      // A ray starting inside the sphere hits it at distance 0.
+      const float t = std::max(-b - std::sqrt(discriminant), 0.0f);
+      if (t <= best && -b + std::sqrt(discriminant) >= 0.0f) {
+        best = t;
+        hit = RayHit{m_entities[p], t};
+        found = true;
+      }
+    }
+  }
+  return found;
+}
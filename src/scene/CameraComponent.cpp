@@ -1,16 +1,52 @@
 #include "scene/CameraComponent.h"
 #include "scene/SceneObject.h"
+#include <cmath>
 #include <glm/gtc/matrix_transform.hpp>
 
+namespace {
+// Inverts a Translation * Rotation * Scale matrix without a general 4x4
+// inverse. The upper 3x3 is R * S, whose inverse is S^-1 * R^T: transpose it
+// and divide row i by the squared length of basis column i. The translation
+// is then rotated back and negated.
+//
+// A world matrix under a non-uniformly scaled parent is sheared, so its
+// basis is not R * S; anything but a uniform, orthogonal basis takes the
+// general inverse.
+glm::mat4 inverse_trs(const glm::mat4 &m) {
+  glm::mat3 basis(m);
+  const glm::vec3 scale_sq(glm::dot(basis[0], basis[0]),
+                           glm::dot(basis[1], basis[1]),
+                           glm::dot(basis[2], basis[2]));
+  const float tolerance = 1e-4f * scale_sq.x;
+  if (std::abs(scale_sq.y - scale_sq.x) > tolerance ||
+      std::abs(scale_sq.z - scale_sq.x) > tolerance ||
+      std::abs(glm::dot(basis[0], basis[1])) > tolerance ||
+      std::abs(glm::dot(basis[0], basis[2])) > tolerance ||
+      std::abs(glm::dot(basis[1], basis[2])) > tolerance) {
+    return glm::inverse(m);
+  }
+  glm::vec3 inv_scale_sq(1.0f / scale_sq.x, 1.0f / scale_sq.y,
+                         1.0f / scale_sq.z);
+  glm::mat3 inv_basis = glm::transpose(basis);
+  for (int col = 0; col < 3; ++col) {
+    inv_basis[col] = inv_basis[col] * inv_scale_sq;
+  }
+
+  glm::mat4 result(inv_basis);
+  result[3] = glm::vec4(-(inv_basis * glm::vec3(m[3])), 1.0f);
+  return result;
+}
+} // namespace
+
 CameraComponent::CameraComponent(float fov, float near_plane, float far_plane)
     : fov(fov), near_plane(near_plane), far_plane(far_plane) {}
 
 glm::mat4 CameraComponent::get_view_matrix() const {
   // ‼️ Lock the weak_ptr to get a temporary shared_ptr
   if (auto owner = m_owner.lock()) {
-    if (owner->transform) {
-      return glm::inverse(owner->transform->get_transform_matrix());
-    }
+    // The matrix the scene is drawn with, so a camera moved by fixed steps
+    // interpolates like everything else.
+    return inverse_trs(owner->transform.get_render_matrix());
   }
   return glm::mat4(1.0f);
 }
@@ -0,0 +1,39 @@
+#include "scene/ComponentStore.h"
+#include "core/JobSystem.h"
+
+std::atomic<uint32_t> ComponentStore::s_next_type_id{0};
+
+namespace {
+// Components per job. Large enough to amortize the queueing overhead, small
+// enough to leave chunks for idle workers to steal.
+constexpr size_t UPDATE_CHUNK_SIZE = 256;
+} // namespace
+
+std::shared_ptr<ComponentStore> ComponentStore::instance() {
+  static std::shared_ptr<ComponentStore> s_instance =
+      std::make_shared<ComponentStore>();
+  return s_instance;
+}
+
+void ComponentStore::update(const Scene &scene, float delta_time) {
+  // Index rather than iterate: a main-thread update may add the first
+  // component of a new type, which grows m_pools.
+  for (size_t id = 0; id < m_pools.size(); ++id) {
+    ComponentPoolBase *pool = m_pools[id].get();
+    if (!pool || !pool->has_update()) {
+      continue;
+    }
+    pool->begin_updates();
+    if (pool->is_parallel_safe()) {
+      JobSystem::parallel_for(
+          pool->live_count(&scene), UPDATE_CHUNK_SIZE,
+          [pool, &scene, delta_time](size_t begin, size_t end) {
+            pool->update_range(&scene, static_cast<uint32_t>(begin),
+                               static_cast<uint32_t>(end), delta_time);
+          });
+    } else {
+      pool->update_range(&scene, 0, pool->live_count(&scene), delta_time);
+    }
+    pool->end_updates();
+  }
+}
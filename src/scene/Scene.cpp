@@ -1,19 +1,105 @@
 #include "scene/Scene.h"
+#include "core/Time.h"
 #include "scene/CameraComponent.h"
 #include "utils/Log.h"
+#include "utils/Profiler.h"
+#include <algorithm>
+#include <cmath>
 
-Scene::Scene() {}
+Scene::Scene()
+    : m_transforms(std::make_shared<TransformStore>()),
+      m_world(std::make_shared<World>()),
+      m_animations(std::make_shared<AnimationSystem>()),
+      m_component_store(ComponentStore::instance()) {}
+
+Scene::~Scene() {
+  // Objects can outlive the scene (e.g. while Lua still references them), so
+  // make sure nothing keeps pointing back at it.
+  for (const auto &object : m_scene_objects) {
+    object->m_scene = nullptr;
+    for (const auto &entry : object->m_components) {
+      entry.pool->set_scene(entry.slot, nullptr);
+    }
+  }
+}
 
 void Scene::add_object(std::shared_ptr<SceneObject> object) {
+  object->move_to(m_transforms, m_world);
+  object->m_scene = this;
+  for (const auto &entry : object->m_components) {
+    entry.pool->set_scene(entry.slot, this);
+    entry.component->on_added_to_scene(*this);
+  }
   m_scene_objects.push_back(object);
 }
 
 void Scene::update(float delta_time) {
-  for (const auto &object : m_scene_objects) {
-    object->update(delta_time);
+  PROFILE_FUNCTION();
+  {
+    PROFILE_ZONE("components");
+    // 1. Components, one linear pass per component type.
+    m_component_store->update(*this, delta_time);
+  }
+  {
+    PROFILE_ZONE("animations");
+    // 2. Batched property animations write straight into the transform
+    // store.
+    m_animations->update(*m_transforms, delta_time,
+                         Time::get_simulation_time());
+  }
+
+  // Components are done moving things; bake the matrices for rendering.
+  {
+    PROFILE_ZONE("transforms");
+    m_transforms->update_world_matrices();
+  }
+  // With fixed steps, interpolate() refits the bounds once per frame from
+  // the blended matrices; refitting after every step would be wasted work.
+  if (!Time::is_fixed_update()) {
+    refit_bounds();
+  }
+}
+
+void Scene::refit_bounds() {
+  {
+    PROFILE_ZONE("bounds");
+    update_bounds();
+  }
+  {
+    PROFILE_ZONE("spatial_index");
+    m_spatial_index.update(*m_world);
   }
 }
 
+void Scene::interpolate(float alpha) {
+  PROFILE_FUNCTION();
+  // Frames without a step still render transforms scripts changed.
+  m_transforms->update_world_matrices();
+  m_transforms->interpolate_world_matrices(alpha);
+  refit_bounds();
+}
+
+void Scene::update_bounds() {
+  const auto &render_matrices = m_transforms->render_matrices();
+  m_world->each_chunk<const TransformLink, const MeshRef, WorldBounds>(
+      [&](uint32_t count, const Entity *, const TransformLink *links,
+          const MeshRef *meshes, WorldBounds *bounds) {
+        for (uint32_t i = 0; i < count; ++i) {
+          const glm::mat4 &m =
+              render_matrices[m_transforms->dense_index(links[i].handle)];
+          const MeshBounds &local = meshes[i].mesh->get_bounds();
+          // Non-uniform scale stretches the sphere by the largest axis scale.
+          float max_scale_sq =
+              std::max({glm::dot(glm::vec3(m[0]), glm::vec3(m[0])),
+                        glm::dot(glm::vec3(m[1]), glm::vec3(m[1])),
+                        glm::dot(glm::vec3(m[2]), glm::vec3(m[2]))});
+          glm::vec3 center = glm::vec3(m * glm::vec4(local.center, 1.0f));
+          bounds[i].sphere =
+              BoundingSphere(center, local.radius * std::sqrt(max_scale_sq));
+        }
+      });
+}
+
 // We return a const reference to avoid making a copy of the entire vector
 // every frame.
 const std::vector<std::shared_ptr<SceneObject>> &
@@ -33,3 +119,44 @@ void Scene::set_active_camera(std::shared_ptr<SceneObject> camera_object) {
 std::shared_ptr<SceneObject> Scene::get_active_camera() const {
   return m_active_camera.lock(); // .lock() converts weak_ptr to shared_ptr
 }
+
+std::vector<std::shared_ptr<SceneObject>>
+Scene::query_sphere(const glm::vec3 &center, float radius) const {
+  m_query_results.clear();
+  m_spatial_index.query_sphere(center, radius, m_query_results);
+  return to_objects(m_query_results);
+}
+
+std::vector<std::shared_ptr<SceneObject>>
+Scene::query_box(const glm::vec3 &min, const glm::vec3 &max) const {
+  m_query_results.clear();
+  m_spatial_index.query_box(Aabb{min, max}, m_query_results);
+  return to_objects(m_query_results);
+}
+
+std::tuple<std::shared_ptr<SceneObject>, float>
+Scene::raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+               float max_distance) const {
+  Bvh::RayHit hit;
+  if (!m_spatial_index.raycast(origin, glm::normalize(direction),
+                               max_distance, hit) ||
+      !m_world->is_alive(hit.entity)) {
+    return {nullptr, 0.0f};
+  }
+  return {m_world->get<ObjectRef>(hit.entity)->object->shared_from_this(),
+          hit.distance};
+}
+
+std::vector<std::shared_ptr<SceneObject>>
+Scene::to_objects(const std::vector<Entity> &entities) const {
+  std::vector<std::shared_ptr<SceneObject>> objects;
+  objects.reserve(entities.size());
+  for (Entity entity : entities) {
+    // Skip entities destroyed since the last update.
+    if (m_world->is_alive(entity)) {
+      objects.push_back(
+          m_world->get<ObjectRef>(entity)->object->shared_from_this());
+    }
+  }
+  return objects;
+}
@@ -1,17 +1,68 @@
 #include "scene/SceneObject.h"
+#include "utils/Log.h"
 
 // The constructor now just takes the mesh
-SceneObject::SceneObject(std::shared_ptr<Mesh> m)
-    : mesh(m), transform(std::make_shared<TransformComponent>()) {}
+SceneObject::SceneObject(std::shared_ptr<Mesh> m) : SceneObject() {
+  set_mesh(std::move(m));
+}
 
 // <-- Add this new constructor implementation
 SceneObject::SceneObject()
-    : mesh(nullptr), transform(std::make_shared<TransformComponent>()) {}
+    : transform(TransformStore::detached()),
+      m_component_store(ComponentStore::instance()),
+      m_world(World::detached()), m_entity(m_world->create()) {
+  m_world->add<TransformLink>(m_entity, TransformLink{transform.get_handle()});
+  m_world->add<ObjectRef>(m_entity, ObjectRef{this});
+}
+
+SceneObject::~SceneObject() {
+  // Newest first, mirroring member destruction order.
+  for (auto it = m_components.rbegin(); it != m_components.rend(); ++it) {
+    it->pool->destroy(it->slot);
+  }
+  m_world->destroy(m_entity);
+}
+
+std::shared_ptr<Mesh> SceneObject::get_mesh() const {
+  const MeshRef *ref = m_world->get<MeshRef>(m_entity);
+  return ref ? ref->mesh : nullptr;
+}
+
+void SceneObject::set_mesh(std::shared_ptr<Mesh> mesh) {
+  if (mesh) {
+    // Swap meshes by re-adding MeshRef rather than assigning it, so the
+    // world's layout version changes and caches of which object uses which
+    // mesh (IndirectDrawPass) rebuild.
+    if (const MeshRef *ref = m_world->get<MeshRef>(m_entity)) {
+      if (ref->mesh == mesh) {
+        return;
+      }
+      m_world->remove<MeshRef>(m_entity);
+    }
+    m_world->add<MeshRef>(m_entity, MeshRef{std::move(mesh)});
+    if (!m_world->has<WorldBounds>(m_entity)) {
+      m_world->add<WorldBounds>(m_entity);
+    }
+  } else {
+    m_world->remove<MeshRef>(m_entity);
+    m_world->remove<WorldBounds>(m_entity);
+  }
+}
 
-// The update function loops through all components and calls their update
-// methods
-void SceneObject::update(float delta_time) {
-  for (const auto &pair : m_components) {
-    pair.second->update(delta_time);
+bool SceneObject::set_parent(const std::shared_ptr<SceneObject> &parent) {
+  if (!transform.set_parent(parent ? &parent->transform : nullptr)) {
+    Log::warn("SceneObject::set_parent failed: objects must be in the same "
+              "scene and the parenting must not form a cycle.");
+    return false;
   }
+  return true;
+}
+
+void SceneObject::move_to(std::shared_ptr<TransformStore> transforms,
+                          std::shared_ptr<World> world) {
+  transform.move_to(std::move(transforms));
+  m_entity = m_world->move_to(m_entity, *world);
+  m_world = std::move(world);
+  // The transform got a new handle in its new store.
+  m_world->get<TransformLink>(m_entity)->handle = transform.get_handle();
 }
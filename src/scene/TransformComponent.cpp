@@ -1,15 +1,83 @@
 #include "scene/TransformComponent.h"
-#include <glm/gtc/matrix_transform.hpp>
+#include <utility>
 
-TransformComponent::TransformComponent(const glm::vec3 &pos,
+TransformComponent::TransformComponent(std::shared_ptr<TransformStore> store,
+                                       const glm::vec3 &pos,
                                        const glm::quat &rot,
                                        const glm::vec3 &scl)
-    : position(pos), rotation(rot), scale(scl) {}
-
-glm::mat4 TransformComponent::get_transform_matrix() const {
-  // TRS: Translation * Rotation * Scale
-  glm::mat4 trans_mat = glm::translate(glm::mat4(1.0f), position);
-  glm::mat4 rot_mat = glm::mat4_cast(rotation);
-  glm::mat4 scale_mat = glm::scale(glm::mat4(1.0f), scale);
-  return trans_mat * rot_mat * scale_mat;
+    : m_store(std::move(store)) {
+  m_handle = m_store->create(pos, rot, scl);
+}
+
+TransformComponent::~TransformComponent() {
+  if (m_store) {
+    m_store->destroy(m_handle);
+  }
+}
+
+const glm::vec3 &TransformComponent::get_position() const {
+  return m_store->positions()[dense_index()];
+}
+
+const glm::quat &TransformComponent::get_rotation() const {
+  return m_store->rotations()[dense_index()];
+}
+
+const glm::vec3 &TransformComponent::get_scale() const {
+  return m_store->scales()[dense_index()];
+}
+
+void TransformComponent::set_position(const glm::vec3 &position) {
+  uint32_t i = dense_index();
+  m_store->positions()[i] = position;
+  m_store->mark_dirty(i);
+}
+
+void TransformComponent::set_rotation(const glm::quat &rotation) {
+  uint32_t i = dense_index();
+  m_store->rotations()[i] = rotation;
+  m_store->mark_dirty(i);
+}
+
+void TransformComponent::set_scale(const glm::vec3 &scale) {
+  uint32_t i = dense_index();
+  m_store->scales()[i] = scale;
+  m_store->mark_dirty(i);
+}
+
+const glm::mat4 &TransformComponent::get_transform_matrix() const {
+  return m_store->world_matrix(dense_index());
+}
+
+const glm::mat4 &TransformComponent::get_world_matrix() const {
+  return m_store->world_matrices()[dense_index()];
+}
+
+const glm::mat4 &TransformComponent::get_render_matrix() const {
+  return m_store->render_matrix(dense_index());
+}
+
+bool TransformComponent::set_parent(const TransformComponent *parent) {
+  if (!parent) {
+    return m_store->set_parent(m_handle, TransformHandle{});
+  }
+  if (parent->m_store != m_store) {
+    return false;
+  }
+  return m_store->set_parent(m_handle, parent->m_handle);
+}
+
+void TransformComponent::move_to(std::shared_ptr<TransformStore> store) {
+  if (store == m_store) {
+    return;
+  }
+  // Copy the values out first; destroying the old slot may reorder the
+  // source arrays.
+  glm::vec3 position = get_position();
+  glm::quat rotation = get_rotation();
+  glm::vec3 scale = get_scale();
+  m_store->destroy(m_handle);
+
+  m_store = std::move(store);
+  m_handle = m_store->create(position, rotation, scale);
 }
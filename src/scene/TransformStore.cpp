@@ -0,0 +1,268 @@
+#include "scene/TransformStore.h"
+#include <algorithm>
+#include <cassert>
+
+namespace {
+constexpr uint32_t INVALID = TransformHandle::INVALID_INDEX;
+} // namespace
+
+std::shared_ptr<TransformStore> TransformStore::detached() {
+  static std::shared_ptr<TransformStore> s_detached =
+      std::make_shared<TransformStore>();
+  return s_detached;
+}
+
+TransformHandle TransformStore::create(const glm::vec3 &pos,
+                                       const glm::quat &rot,
+                                       const glm::vec3 &scl) {
+  // Reuse a free slot if there is one, otherwise grow the sparse table.
+  uint32_t slot;
+  if (!m_free_slots.empty()) {
+    slot = m_free_slots.back();
+    m_free_slots.pop_back();
+  } else {
+    slot = static_cast<uint32_t>(m_slot_to_dense.size());
+    m_slot_to_dense.push_back(0);
+    m_generations.push_back(0);
+    m_parent.push_back(INVALID);
+    m_first_child.push_back(INVALID);
+    m_next_sibling.push_back(INVALID);
+  }
+
+  // New transforms are always appended to the dense arrays.
+  uint32_t dense = static_cast<uint32_t>(m_positions.size());
+  m_slot_to_dense[slot] = dense;
+  m_dense_to_slot.push_back(slot);
+  m_positions.push_back(pos);
+  m_rotations.push_back(rot);
+  m_scales.push_back(scl);
+  glm::mat4 local = compose_matrix(pos, rot, scl);
+  m_local_matrices.push_back(local);
+  m_world_matrices.push_back(local);
+  m_dirty.push_back(0);
+  // The blended matrices have no entry for it; render the world matrices
+  // until the next interpolate.
+  m_interpolated = false;
+
+  // A new root can go at the end of the update order without a rebuild.
+  m_parent_dense.push_back(INVALID);
+  if (!m_order_dirty) {
+    m_order.push_back(dense);
+  }
+
+  return TransformHandle{slot, m_generations[slot]};
+}
+
+void TransformStore::destroy(TransformHandle handle) {
+  if (!is_alive(handle)) {
+    return;
+  }
+
+  // Orphan the children and detach from the parent.
+  uint32_t child = m_first_child[handle.index];
+  while (child != INVALID) {
+    uint32_t next = m_next_sibling[child];
+    m_parent[child] = INVALID;
+    m_next_sibling[child] = INVALID;
+    mark_dirty(m_slot_to_dense[child]);
+    child = next;
+  }
+  m_first_child[handle.index] = INVALID;
+  unlink_from_parent(handle.index);
+
+  // The blended matrices no longer line up with the dense layout.
+  m_interpolated = false;
+
+  // Move the last transform into the hole to keep the arrays dense.
+  uint32_t dense = m_slot_to_dense[handle.index];
+  uint32_t last = static_cast<uint32_t>(m_positions.size() - 1);
+  if (dense != last) {
+    m_positions[dense] = m_positions[last];
+    m_rotations[dense] = m_rotations[last];
+    m_scales[dense] = m_scales[last];
+    m_local_matrices[dense] = m_local_matrices[last];
+    m_world_matrices[dense] = m_world_matrices[last];
+    m_dirty[dense] = m_dirty[last];
+    m_dense_to_slot[dense] = m_dense_to_slot[last];
+    m_slot_to_dense[m_dense_to_slot[dense]] = dense;
+  }
+  m_positions.pop_back();
+  m_rotations.pop_back();
+  m_scales.pop_back();
+  m_local_matrices.pop_back();
+  m_world_matrices.pop_back();
+  m_dirty.pop_back();
+  m_dense_to_slot.pop_back();
+  m_parent_dense.pop_back();
+
+  // Bumping the generation invalidates any handles still pointing here.
+  m_generations[handle.index]++;
+  m_free_slots.push_back(handle.index);
+
+  // Dense indices moved, so the update order must be rebuilt.
+  m_order_dirty = true;
+  m_layout_version++;
+}
+
+bool TransformStore::is_alive(TransformHandle handle) const {
+  return handle.index < m_generations.size() &&
+         m_generations[handle.index] == handle.generation;
+}
+
+bool TransformStore::set_parent(TransformHandle child, TransformHandle parent) {
+  if (!is_alive(child)) {
+    return false;
+  }
+  uint32_t parent_slot = is_alive(parent) ? parent.index : INVALID;
+  if (m_parent[child.index] == parent_slot) {
+    return true;
+  }
+
+  // Walk up from the new parent; reaching the child means a cycle.
+  for (uint32_t slot = parent_slot; slot != INVALID; slot = m_parent[slot]) {
+    if (slot == child.index) {
+      return false;
+    }
+  }
+
+  unlink_from_parent(child.index);
+  if (parent_slot != INVALID) {
+    m_parent[child.index] = parent_slot;
+    m_next_sibling[child.index] = m_first_child[parent_slot];
+    m_first_child[parent_slot] = child.index;
+  }
+
+  mark_dirty(m_slot_to_dense[child.index]);
+  m_order_dirty = true;
+  return true;
+}
+
+TransformHandle TransformStore::get_parent(TransformHandle handle) const {
+  if (!is_alive(handle) || m_parent[handle.index] == INVALID) {
+    return TransformHandle{};
+  }
+  uint32_t parent_slot = m_parent[handle.index];
+  return TransformHandle{parent_slot, m_generations[parent_slot]};
+}
+
+void TransformStore::unlink_from_parent(uint32_t child_slot) {
+  uint32_t parent_slot = m_parent[child_slot];
+  if (parent_slot == INVALID) {
+    return;
+  }
+  // Singly linked sibling list: find the link that points at the child.
+  uint32_t *link = &m_first_child[parent_slot];
+  while (*link != child_slot) {
+    link = &m_next_sibling[*link];
+  }
+  *link = m_next_sibling[child_slot];
+  m_parent[child_slot] = INVALID;
+  m_next_sibling[child_slot] = INVALID;
+}
+
+void TransformStore::rebuild_order() {
+  // Breadth-first walk from every root. m_order doubles as the queue, so
+  // there is no recursion and no allocation once the vectors have grown.
+  m_order.clear();
+  const uint32_t count = static_cast<uint32_t>(m_positions.size());
+  for (uint32_t dense = 0; dense < count; ++dense) {
+    if (m_parent[m_dense_to_slot[dense]] == INVALID) {
+      m_parent_dense[dense] = INVALID;
+      m_order.push_back(dense);
+    }
+  }
+  for (size_t head = 0; head < m_order.size(); ++head) {
+    uint32_t parent = m_order[head];
+    uint32_t child = m_first_child[m_dense_to_slot[parent]];
+    for (; child != INVALID; child = m_next_sibling[child]) {
+      uint32_t child_dense = m_slot_to_dense[child];
+      m_parent_dense[child_dense] = parent;
+      m_order.push_back(child_dense);
+    }
+  }
+  m_order_dirty = false;
+}
+
+const glm::mat4 &TransformStore::world_matrix(uint32_t dense) const {
+  assert(!is_stale(dense) &&
+         "world_matrix() read before update_world_matrices()");
+  return m_world_matrices[dense];
+}
+
+bool TransformStore::is_stale(uint32_t dense) const {
+  for (uint32_t i = dense; i != INVALID;) {
+    if (m_dirty[i]) {
+      return true;
+    }
+    uint32_t parent_slot = m_parent[m_dense_to_slot[i]];
+    i = parent_slot == INVALID ? INVALID : m_slot_to_dense[parent_slot];
+  }
+  return false;
+}
+
+void TransformStore::update_world_matrices() {
+  if (m_order_dirty) {
+    rebuild_order();
+  }
+
+  m_world_changed.assign(m_positions.size(), 0);
+  for (uint32_t i : m_order) {
+    uint32_t parent = m_parent_dense[i];
+    bool parent_changed = parent != INVALID && m_world_changed[parent];
+    if (!m_dirty[i] && !parent_changed) {
+      continue;
+    }
+
+    if (m_dirty[i]) {
+      m_local_matrices[i] =
+          compose_matrix(m_positions[i], m_rotations[i], m_scales[i]);
+      m_dirty[i] = 0;
+    }
+    // Parents come first in m_order, so their world matrix is current.
+    m_world_matrices[i] = parent == INVALID
+                              ? m_local_matrices[i]
+                              : m_world_matrices[parent] * m_local_matrices[i];
+    m_world_changed[i] = 1;
+  }
+  m_interpolated = false;
+}
+
+void TransformStore::store_previous_world_matrices() {
+  // Assigning reuses the capacity, so this doesn't allocate per step.
+  m_previous_world_matrices = m_world_matrices;
+  m_previous_layout_version = m_layout_version;
+}
+
+void TransformStore::interpolate_world_matrices(float alpha) {
+  const size_t count = m_world_matrices.size();
+  m_render_matrices.resize(count);
+  // Transforms created since the snapshot have nothing to blend from, and a
+  // destroy since then moved dense entries around.
+  const size_t blended =
+      m_previous_layout_version == m_layout_version
+          ? std::min(count, m_previous_world_matrices.size())
+          : 0;
+  // A per-element blend, not a slerp: close enough over one step, and it
+  // keeps this a straight pass over the arrays.
+  for (size_t i = 0; i < blended; ++i) {
+    const glm::mat4 &previous = m_previous_world_matrices[i];
+    m_render_matrices[i] = previous + (m_world_matrices[i] - previous) * alpha;
+  }
+  std::copy(m_world_matrices.begin() + static_cast<std::ptrdiff_t>(blended),
+            m_world_matrices.end(),
+            m_render_matrices.begin() + static_cast<std::ptrdiff_t>(blended));
+  m_interpolated = true;
+}
+
+glm::mat4 TransformStore::compose_matrix(const glm::vec3 &position,
+                                         const glm::quat &rotation,
+                                         const glm::vec3 &scale) {
+  // Equivalent to translate * mat4_cast(rotation) * scale, without the two
+  // full 4x4 multiplies.
+  glm::mat4 matrix = glm::mat4_cast(rotation);
+  matrix[0] *= scale.x;
+  matrix[1] *= scale.y;
+  matrix[2] *= scale.z;
+  matrix[3] = glm::vec4(position, 1.0f);
+  return matrix;
+}
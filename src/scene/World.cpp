@@ -0,0 +1,286 @@
+#include "scene/World.h"
+#include "utils/Log.h"
+#include <cstdlib>
+
+std::array<World::TypeInfo, World::MAX_TYPES> World::s_types;
+std::atomic<uint32_t> World::s_type_count{0};
+
+namespace {
+constexpr uint32_t GENERATION_MASK = (1u << (32 - Entity::INDEX_BITS)) - 1;
+} // namespace
+
+std::shared_ptr<World> World::detached() {
+  static std::shared_ptr<World> s_detached = std::make_shared<World>();
+  return s_detached;
+}
+
+uint32_t World::register_type(const TypeInfo &info) {
+  const uint32_t id = s_type_count++;
+  if (id >= MAX_TYPES || info.align > alignof(Chunk)) {
+    Log::error("World: too many data types, or one is over-aligned.");
+    std::abort();
+  }
+  s_types[id] = info;
+  return id;
+}
+
+World::World() {
+  // Archetype 0 is the empty signature every new entity starts in.
+  find_or_create_archetype(0);
+}
+
+World::~World() {
+  for (const auto &archetype : m_archetypes) {
+    for (uint32_t row = 0; row < archetype->size; ++row) {
+      unsigned char *base = row_address(*archetype, row);
+      for (size_t col = 0; col < archetype->types.size(); ++col) {
+        const TypeInfo &info = s_types[archetype->types[col]];
+        info.destroy(base + archetype->offsets[col] +
+                     (row % archetype->capacity) * info.size);
+      }
+    }
+  }
+}
+
+// --- Entities ---
+
+Entity World::create() {
+  uint32_t index;
+  if (!m_free_records.empty()) {
+    index = m_free_records.back();
+    m_free_records.pop_back();
+  } else {
+    index = static_cast<uint32_t>(m_records.size());
+    // The all-ones index is reserved so no id can equal INVALID_ID.
+    if (index >= Entity::INDEX_MASK) {
+      Log::error("World: entity limit reached.");
+      return Entity{};
+    }
+    m_records.push_back(Record{});
+  }
+
+  Record &record = m_records[index];
+  Entity entity{index | (record.generation << Entity::INDEX_BITS)};
+  record.archetype = 0;
+  record.row = allocate_row(*m_archetypes[0], entity);
+  m_live_count++;
+  return entity;
+}
+
+void World::destroy(Entity entity) {
+  if (!is_alive(entity)) {
+    return;
+  }
+  Record &record = m_records[entity.index()];
+  Archetype &archetype = *m_archetypes[record.archetype];
+  unsigned char *base = row_address(archetype, record.row);
+  for (size_t col = 0; col < archetype.types.size(); ++col) {
+    const TypeInfo &info = s_types[archetype.types[col]];
+    info.destroy(base + archetype.offsets[col] +
+                 (record.row % archetype.capacity) * info.size);
+  }
+  remove_row(archetype, record.row);
+
+  record.generation = (record.generation + 1) & GENERATION_MASK;
+  m_free_records.push_back(entity.index());
+  m_live_count--;
+}
+
+bool World::is_alive(Entity entity) const {
+  // Destroying bumps the record's generation, so ids handed out before
+  // that no longer match.
+  return entity.is_valid() && entity.index() < m_records.size() &&
+         m_records[entity.index()].generation == entity.generation();
+}
+
+Entity World::move_to(Entity entity, World &dest) {
+  if (!is_alive(entity)) {
+    return Entity{};
+  }
+  if (&dest == this) {
+    return entity;
+  }
+
+  Record &record = m_records[entity.index()];
+  Archetype &from = *m_archetypes[record.archetype];
+  Entity moved = dest.create();
+  if (!moved.is_valid()) {
+    return moved;
+  }
+
+  // Type ids are global, so the signature means the same thing in `dest`.
+  Record &dest_record = dest.m_records[moved.index()];
+  const uint32_t dest_index = dest.find_or_create_archetype(from.signature);
+  dest.move_entity(moved.index(), dest_index, NO_TYPE);
+
+  Archetype &to = *dest.m_archetypes[dest_index];
+  unsigned char *src_base = row_address(from, record.row);
+  unsigned char *dst_base = dest.row_address(to, dest_record.row);
+  for (size_t col = 0; col < from.types.size(); ++col) {
+    const TypeInfo &info = s_types[from.types[col]];
+    void *src = src_base + from.offsets[col] +
+                (record.row % from.capacity) * info.size;
+    void *dst = dst_base + to.offsets[col] +
+                (dest_record.row % to.capacity) * info.size;
+    info.move(dst, src);
+    info.destroy(src);
+  }
+  remove_row(from, record.row);
+
+  record.generation = (record.generation + 1) & GENERATION_MASK;
+  m_free_records.push_back(entity.index());
+  m_live_count--;
+  return moved;
+}
+
+// --- Archetypes ---
+
+uint32_t World::find_or_create_archetype(uint64_t signature) {
+  auto it = m_archetype_lookup.find(signature);
+  if (it != m_archetype_lookup.end()) {
+    return it->second;
+  }
+
+  auto archetype = std::make_unique<Archetype>();
+  archetype->signature = signature;
+  archetype->column.fill(NO_COLUMN);
+  archetype->add_edge.fill(NO_ARCHETYPE);
+  archetype->remove_edge.fill(NO_ARCHETYPE);
+  size_t row_bytes = sizeof(Entity);
+  for (uint32_t type = 0; type < MAX_TYPES; ++type) {
+    if (signature & (uint64_t(1) << type)) {
+      archetype->column[type] = static_cast<uint8_t>(archetype->types.size());
+      archetype->types.push_back(type);
+      row_bytes += s_types[type].size;
+    }
+  }
+
+  // Start from the unpadded estimate and shrink until the aligned arrays fit.
+  archetype->offsets.resize(archetype->types.size());
+  uint32_t capacity = static_cast<uint32_t>(CHUNK_SIZE / row_bytes);
+  for (;; --capacity) {
+    size_t end = capacity * sizeof(Entity);
+    for (size_t col = 0; col < archetype->types.size(); ++col) {
+      const TypeInfo &info = s_types[archetype->types[col]];
+      end = (end + info.align - 1) / info.align * info.align;
+      archetype->offsets[col] = static_cast<uint32_t>(end);
+      end += capacity * info.size;
+    }
+    if (end <= CHUNK_SIZE) {
+      break;
+    }
+  }
+  if (capacity == 0) {
+    Log::error("World: an entity's data does not fit in one chunk.");
+    std::abort();
+  }
+  archetype->capacity = capacity;
+
+  const uint32_t index = static_cast<uint32_t>(m_archetypes.size());
+  m_archetypes.push_back(std::move(archetype));
+  m_archetype_lookup.emplace(signature, index);
+  return index;
+}
+
+uint32_t World::archetype_edge(uint32_t from, uint32_t type, bool add) {
+  auto &edges =
+      add ? m_archetypes[from]->add_edge : m_archetypes[from]->remove_edge;
+  if (edges[type] == NO_ARCHETYPE) {
+    const uint64_t bit = uint64_t(1) << type;
+    const uint64_t signature = add ? m_archetypes[from]->signature | bit
+                                   : m_archetypes[from]->signature & ~bit;
+    // May grow m_archetypes; `edges` points into a heap Archetype, so it
+    // stays valid.
+    edges[type] = find_or_create_archetype(signature);
+  }
+  return edges[type];
+}
+
+// --- Rows ---
+
+uint32_t World::allocate_row(Archetype &archetype, Entity entity) {
+  m_layout_version++;
+  const uint32_t row = archetype.size++;
+  if (row / archetype.capacity == archetype.chunks.size()) {
+    // Default-initialized: no need to zero 16 KB.
+    archetype.chunks.push_back(std::unique_ptr<Chunk>(new Chunk));
+  }
+  entity_at(archetype, row) = entity;
+  return row;
+}
+
+void World::remove_row(Archetype &archetype, uint32_t row) {
+  m_layout_version++;
+  const uint32_t last = archetype.size - 1;
+  if (row != last) {
+    unsigned char *dst_base = row_address(archetype, row);
+    unsigned char *src_base = row_address(archetype, last);
+    for (size_t col = 0; col < archetype.types.size(); ++col) {
+      const TypeInfo &info = s_types[archetype.types[col]];
+      void *dst = dst_base + archetype.offsets[col] +
+                  (row % archetype.capacity) * info.size;
+      void *src = src_base + archetype.offsets[col] +
+                  (last % archetype.capacity) * info.size;
+      info.move(dst, src);
+      info.destroy(src);
+    }
+    Entity moved = entity_at(archetype, last);
+    entity_at(archetype, row) = moved;
+    m_records[moved.index()].row = row;
+  }
+  archetype.size--;
+
+  // Release the last chunk once it empties.
+  if (archetype.size % archetype.capacity == 0 &&
+      archetype.chunks.size() > archetype.size / archetype.capacity) {
+    archetype.chunks.pop_back();
+  }
+}
+
+void World::move_entity(uint32_t index, uint32_t dest, uint32_t skip_type) {
+  Record &record = m_records[index];
+  if (record.archetype == dest) {
+    return;
+  }
+  Archetype &from = *m_archetypes[record.archetype];
+  Archetype &to = *m_archetypes[dest];
+  const Entity entity = entity_at(from, record.row);
+  const uint32_t new_row = allocate_row(to, entity);
+
+  unsigned char *src_base = row_address(from, record.row);
+  unsigned char *dst_base = row_address(to, new_row);
+  for (size_t col = 0; col < from.types.size(); ++col) {
+    const uint32_t type = from.types[col];
+    const TypeInfo &info = s_types[type];
+    void *src = src_base + from.offsets[col] +
+                (record.row % from.capacity) * info.size;
+    const uint8_t dest_col = to.column[type];
+    if (dest_col != NO_COLUMN && type != skip_type) {
+      info.move(dst_base + to.offsets[dest_col] +
+                    (new_row % to.capacity) * info.size,
+                src);
+    }
+    info.destroy(src);
+  }
+  remove_row(from, record.row);
+
+  record.archetype = dest;
+  record.row = new_row;
+}
+
+unsigned char *World::row_address(const Archetype &archetype,
+                                  uint32_t row) const {
+  return archetype.chunks[row / archetype.capacity]->data;
+}
+
+void *World::column_address(const Record &record, uint32_t type) {
+  const Archetype &archetype = *m_archetypes[record.archetype];
+  const uint8_t col = archetype.column[type];
+  return row_address(archetype, record.row) + archetype.offsets[col] +
+         (record.row % archetype.capacity) * s_types[type].size;
+}
+
+Entity &World::entity_at(const Archetype &archetype, uint32_t row) {
+  return reinterpret_cast<Entity *>(
+      row_address(archetype, row))[row % archetype.capacity];
+}
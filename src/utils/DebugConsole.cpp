@@ -1,4 +1,5 @@
 #include "utils/DebugConsole.h"
+#include "graphics/GpuProfiler.h"
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -52,9 +53,14 @@ int DebugConsole::text_edit_callback(ImGuiInputTextCallbackData *data) {
 }
 
 DebugConsole::DebugConsole()
-    : m_input_buffer{0}, m_history_pos(-1), m_is_visible(false) {}
+    : m_input_buffer{0}, m_history_pos(-1), m_is_visible(false),
+      m_initialized(false) {}
 
 DebugConsole::~DebugConsole() {
+  // Headless runs never create the ImGui context.
+  if (!m_initialized) {
+    return;
+  }
   ImGui_ImplOpenGL3_Shutdown();
   ImGui_ImplGlfw_Shutdown();
   ImGui::DestroyContext();
@@ -74,6 +80,7 @@ void DebugConsole::init(GLFWwindow *window) {
   ImGui_ImplOpenGL3_Init("#version 330");
 
   add_log("Welcome to the interactive console! Press ` to toggle.");
+  m_initialized = true;
 }
 
 void DebugConsole::set_command_callback(
@@ -110,8 +117,41 @@ void DebugConsole::on_key_pressed(int key) {
   }
 }
 
+void DebugConsole::draw_gpu_timings() {
+  bool enabled = GpuProfiler::is_enabled();
+  if (ImGui::Checkbox("Enabled", &enabled)) {
+    GpuProfiler::set_enabled(enabled);
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Reset")) {
+    GpuProfiler::reset();
+  }
+  if (ImGui::BeginTable("GpuTimings", 5,
+                        ImGuiTableFlags_RowBg |
+                            ImGuiTableFlags_SizingStretchProp)) {
+    ImGui::TableSetupColumn("Pass");
+    ImGui::TableSetupColumn("Last ms");
+    ImGui::TableSetupColumn("Min");
+    ImGui::TableSetupColumn("Avg");
+    ImGui::TableSetupColumn("Max");
+    ImGui::TableHeadersRow();
+    for (const auto &pass : GpuProfiler::get_stats()) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      const std::string name = std::string(pass.depth * 2, ' ') + pass.name;
+      ImGui::TextUnformatted(name.c_str());
+      for (float value :
+           {pass.last_ms, pass.min_ms, pass.avg_ms, pass.max_ms}) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", value);
+      }
+    }
+    ImGui::EndTable();
+  }
+}
+
 void DebugConsole::draw() {
-  if (!m_is_visible) {
+  if (!m_is_visible || !m_initialized) {
     return;
   }
 
@@ -122,6 +162,10 @@ void DebugConsole::draw() {
 
   ImGui::SetNextWindowSize(ImVec2(520, 600), ImGuiCond_FirstUseEver);
   if (ImGui::Begin("Console", &m_is_visible)) {
+    if (ImGui::CollapsingHeader("GPU timings")) {
+      draw_gpu_timings();
+    }
+
     // Log history
     ImGui::BeginChild("ScrollingRegion",
                       ImVec2(0, -ImGui::GetFrameHeightWithSpacing()), false,
@@ -148,6 +192,7 @@ void DebugConsole::draw() {
   ImGui::End();
 
   // Rendering
+  GpuProfiler::Scope pass("imgui");
   ImGui::Render();
   ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
@@ -0,0 +1,167 @@
+#include "utils/ImageWriter.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#ifdef HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+// Largest payload of one uncompressed deflate block.
+constexpr size_t STORED_BLOCK_SIZE = 65535;
+
+const std::array<uint32_t, 256> &crc_table() {
+  static const std::array<uint32_t, 256> s_table = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      }
+      table[n] = c;
+    }
+    return table;
+  }();
+  return s_table;
+}
+
+uint32_t crc32_update(uint32_t crc, const unsigned char *data, size_t size) {
+  const auto &table = crc_table();
+  for (size_t i = 0; i < size; ++i) {
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+void put_u32(std::vector<unsigned char> &out, uint32_t value) {
+  out.push_back(static_cast<unsigned char>(value >> 24));
+  out.push_back(static_cast<unsigned char>(value >> 16));
+  out.push_back(static_cast<unsigned char>(value >> 8));
+  out.push_back(static_cast<unsigned char>(value));
+}
+
+void write_chunk(std::ostream &out, const char type[4],
+                 const std::vector<unsigned char> &data) {
+  std::vector<unsigned char> header;
+  put_u32(header, static_cast<uint32_t>(data.size()));
+  header.insert(header.end(), type, type + 4);
+  out.write(reinterpret_cast<const char *>(header.data()), 8);
+  out.write(reinterpret_cast<const char *>(data.data()),
+            static_cast<std::streamsize>(data.size()));
+
+  uint32_t crc = crc32_update(0xFFFFFFFFu, header.data() + 4, 4);
+  crc = crc32_update(crc, data.data(), data.size()) ^ 0xFFFFFFFFu;
+  std::vector<unsigned char> footer;
+  put_u32(footer, crc);
+  out.write(reinterpret_cast<const char *>(footer.data()), 4);
+}
+
+// Wraps `raw` in a zlib stream.
+std::vector<unsigned char>
+zlib_stream(const std::vector<unsigned char> &raw) {
+#ifdef HAS_ZLIB
+  uLongf size = compressBound(static_cast<uLong>(raw.size()));
+  std::vector<unsigned char> compressed(size);
+  // Fastest level: capture runs alongside rendering.
+  if (compress2(compressed.data(), &size, raw.data(),
+                static_cast<uLong>(raw.size()), Z_BEST_SPEED) == Z_OK) {
+    compressed.resize(size);
+    return compressed;
+  }
+#endif
+  // Stored blocks: no compression, but a valid stream any decoder reads.
+  std::vector<unsigned char> out;
+  out.reserve(raw.size() + raw.size() / STORED_BLOCK_SIZE * 5 + 16);
+  out.push_back(0x78);
+  out.push_back(0x01);
+  size_t offset = 0;
+  do {
+    const size_t size = std::min(raw.size() - offset, STORED_BLOCK_SIZE);
+    const bool last = offset + size == raw.size();
+    out.push_back(last ? 1 : 0);
+    out.push_back(static_cast<unsigned char>(size));
+    out.push_back(static_cast<unsigned char>(size >> 8));
+    out.push_back(static_cast<unsigned char>(~size));
+    out.push_back(static_cast<unsigned char>(~size >> 8));
+    out.insert(out.end(), raw.begin() + offset, raw.begin() + offset + size);
+    offset += size;
+  } while (offset < raw.size());
+
+  uint32_t a = 1;
+  uint32_t b = 0;
+  for (unsigned char byte : raw) {
+    a = (a + byte) % 65521;
+    b = (b + a) % 65521;
+  }
+  put_u32(out, (b << 16) | a);
+  return out;
+}
+
+unsigned char clamp_sample(int value) {
+  return static_cast<unsigned char>(value < 0 ? 0 : value > 255 ? 255 : value);
+}
+} // namespace
+
+bool ImageWriter::write_png(const std::string &path, unsigned int width,
+                            unsigned int height, const unsigned char *pixels) {
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    return false;
+  }
+  static const unsigned char SIGNATURE[8] = {0x89, 'P',  'N',  'G',
+                                             '\r', '\n', 0x1A, '\n'};
+  out.write(reinterpret_cast<const char *>(SIGNATURE), sizeof(SIGNATURE));
+
+  std::vector<unsigned char> header;
+  put_u32(header, width);
+  put_u32(header, height);
+  header.push_back(8); // Bit depth
+  header.push_back(6); // Color type: RGBA
+  header.push_back(0); // Compression
+  header.push_back(0); // Filter method
+  header.push_back(0); // No interlacing
+  write_chunk(out, "IHDR", header);
+
+  // Each row is prefixed with its filter type (0 = none).
+  const size_t row_bytes = size_t(width) * 4;
+  std::vector<unsigned char> raw;
+  raw.reserve((row_bytes + 1) * height);
+  for (unsigned int y = 0; y < height; ++y) {
+    raw.push_back(0);
+    const unsigned char *row = pixels + y * row_bytes;
+    raw.insert(raw.end(), row, row + row_bytes);
+  }
+  write_chunk(out, "IDAT", zlib_stream(raw));
+  write_chunk(out, "IEND", {});
+  return static_cast<bool>(out);
+}
+
+void ImageWriter::write_y4m_header(std::ostream &out, unsigned int width,
+                                   unsigned int height, unsigned int fps) {
+  out << "YUV4MPEG2 W" << width << " H" << height << " F" << fps
+      << ":1 Ip A1:1 C444\n";
+}
+
+void ImageWriter::write_y4m_frame(std::ostream &out, unsigned int width,
+                                  unsigned int height,
+                                  const unsigned char *pixels) {
+  const size_t count = size_t(width) * height;
+  std::vector<unsigned char> planes(count * 3);
+  unsigned char *y_plane = planes.data();
+  unsigned char *u_plane = y_plane + count;
+  unsigned char *v_plane = u_plane + count;
+  for (size_t i = 0; i < count; ++i) {
+    const int r = pixels[i * 4];
+    const int g = pixels[i * 4 + 1];
+    const int b = pixels[i * 4 + 2];
+    y_plane[i] = clamp_sample(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    u_plane[i] = clamp_sample(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    v_plane[i] = clamp_sample(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+  }
+  out << "FRAME\n";
+  out.write(reinterpret_cast<const char *>(planes.data()),
+            static_cast<std::streamsize>(planes.size()));
+}
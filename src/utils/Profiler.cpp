@@ -0,0 +1,181 @@
+#include "utils/Profiler.h"
+#include "utils/Log.h"
+#include <chrono>
+
+#ifdef ENABLE_PROFILER
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+struct ZoneRecord {
+  const char *name;
+  uint64_t start;
+  uint64_t end;
+};
+
+// A ring entry. Exporters may read one while its owner rewrites it, so the
+// fields are relaxed atomics (plain moves on x86); `head` tells which
+// entries to trust.
+struct ZoneSlot {
+  std::atomic<const char *> name{nullptr};
+  std::atomic<uint64_t> start{0};
+  std::atomic<uint64_t> end{0};
+};
+
+// One per thread that ever recorded a zone. Only the owning thread writes;
+// `head` publishes each finished record to exporters.
+struct ThreadRing {
+  std::atomic<uint64_t> head{0};    // Zones ever recorded
+  std::atomic<uint64_t> cleared{0}; // Zones before this were cleared
+  uint32_t thread_id = 0;
+  std::string name; // Guarded by s_rings_mutex
+  std::unique_ptr<ZoneSlot[]> zones{new ZoneSlot[Profiler::RING_CAPACITY]};
+};
+
+std::mutex s_rings_mutex;
+// Never freed, so zones of threads that have exited still export.
+std::vector<std::unique_ptr<ThreadRing>> s_rings;
+thread_local ThreadRing *t_ring = nullptr;
+
+// Pairs a tick with a clock reading to convert ticks to microseconds.
+const uint64_t s_origin_ticks = Profiler::now();
+const auto s_origin_time = std::chrono::steady_clock::now();
+
+ThreadRing &thread_ring() {
+  if (!t_ring) {
+    auto ring = std::make_unique<ThreadRing>();
+    std::lock_guard<std::mutex> lock(s_rings_mutex);
+    ring->thread_id = static_cast<uint32_t>(s_rings.size() + 1);
+    ring->name = "thread " + std::to_string(ring->thread_id);
+    t_ring = ring.get();
+    s_rings.push_back(std::move(ring));
+  }
+  return *t_ring;
+}
+} // namespace
+
+void Profiler::record(const char *name, uint64_t start, uint64_t end) {
+  ThreadRing &ring = thread_ring();
+  const uint64_t index = ring.head.load(std::memory_order_relaxed);
+  ZoneSlot &slot = ring.zones[index % RING_CAPACITY];
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.start.store(start, std::memory_order_relaxed);
+  slot.end.store(end, std::memory_order_relaxed);
+  ring.head.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::set_thread_name(const char *name) {
+  ThreadRing &ring = thread_ring();
+  std::lock_guard<std::mutex> lock(s_rings_mutex);
+  ring.name = name;
+}
+
+void Profiler::clear() {
+  std::lock_guard<std::mutex> lock(s_rings_mutex);
+  for (const auto &ring : s_rings) {
+    ring->cleared.store(ring->head.load(std::memory_order_acquire),
+                        std::memory_order_relaxed);
+  }
+}
+
+bool Profiler::write_chrome_trace(const std::string &path) {
+  std::ofstream out(path);
+  if (!out) {
+    Log::error("Profiler: failed to open " + path);
+    return false;
+  }
+
+  // Calibrate over the whole run for the best TSC-to-time estimate.
+  const double elapsed_us =
+      std::chrono::duration<double, std::micro>(
+          std::chrono::steady_clock::now() - s_origin_time)
+          .count();
+  const uint64_t elapsed_ticks = now() - s_origin_ticks;
+  const double us_per_tick =
+      elapsed_ticks > 0 ? elapsed_us / static_cast<double>(elapsed_ticks)
+                        : 0.0;
+
+  std::lock_guard<std::mutex> lock(s_rings_mutex);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  char line[256];
+  size_t zone_count = 0;
+  std::vector<ZoneRecord> zones;
+  for (const auto &ring : s_rings) {
+    // Names are identifiers and literals; nothing to escape.
+    std::snprintf(line, sizeof(line),
+                  "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,"
+                  "\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                  first ? "" : ",", ring->thread_id, ring->name.c_str());
+    out << line;
+    first = false;
+
+    // Copy out, then keep only records the owner could not have been
+    // overwriting meanwhile.
+    const uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t begin = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+    begin = std::max(begin, ring->cleared.load(std::memory_order_relaxed));
+    zones.clear();
+    for (uint64_t i = begin; i < head; ++i) {
+      const ZoneSlot &slot = ring->zones[i % RING_CAPACITY];
+      zones.push_back(ZoneRecord{slot.name.load(std::memory_order_relaxed),
+                                 slot.start.load(std::memory_order_relaxed),
+                                 slot.end.load(std::memory_order_relaxed)});
+    }
+    const uint64_t head_after = ring->head.load(std::memory_order_acquire);
+    const uint64_t overwritten =
+        head_after >= RING_CAPACITY ? head_after - RING_CAPACITY + 1 : 0;
+    const size_t skip =
+        overwritten > begin
+            ? static_cast<size_t>(std::min(overwritten - begin, head - begin))
+            : 0;
+
+    for (size_t i = skip; i < zones.size(); ++i) {
+      const ZoneRecord &zone = zones[i];
+      const double ts =
+          static_cast<double>(static_cast<int64_t>(zone.start -
+                                                   s_origin_ticks)) *
+          us_per_tick;
+      const double dur = static_cast<double>(zone.end - zone.start) *
+                         us_per_tick;
+      std::snprintf(line, sizeof(line),
+                    ",\n{\"ph\":\"X\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,"
+                    "\"ts\":%.3f,\"dur\":%.3f}",
+                    zone.name, ring->thread_id, ts, dur);
+      out << line;
+      zone_count++;
+    }
+  }
+  out << "\n]}\n";
+  Log::info("Profiler: wrote " + std::to_string(zone_count) + " zones to " +
+            path);
+  return static_cast<bool>(out);
+}
+
+#else
+
+void Profiler::record(const char *, uint64_t, uint64_t) {}
+
+void Profiler::set_thread_name(const char *) {}
+
+void Profiler::clear() {}
+
+bool Profiler::write_chrome_trace(const std::string &path) {
+  Log::warn("Profiler: built without ENABLE_PROFILER; nothing to write to " +
+            path);
+  return false;
+}
+
+#endif
+
+uint64_t Profiler::now_steady() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
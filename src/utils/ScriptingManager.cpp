@@ -1,6 +1,8 @@
 #include "utils/ScriptingManager.h"
 #include "core/ScriptingContext.h"
 #include "core/Settings.h"
+#include "graphics/FrameCapture.h"
+#include "graphics/GpuProfiler.h"
 #include "graphics/Shader.h"
 #include "graphics/renderers/GraphicsRenderer.h"
 #include "graphics/renderers/IRenderer.h"
@@ -8,13 +10,102 @@
 #include "scene/PropertyAnimatorComponent.h"
 #include "scene/Scene.h"
 #include "scene/SceneObject.h"
+#include "scene/TransformStore.h"
 #include "utils/Log.h"
+#include "utils/Profiler.h"
 #include "utils/ResourceManager.h"
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <memory>
+#include <vector>
 
 // Instantiate the static lua state
 std::unique_ptr<sol::state> ScriptingManager::s_lua_state = nullptr;
 
+namespace {
+// A live view of one property of a transform, handed to Lua in place of a
+// copy so `obj.transform.position.x = 1` writes through to the
+// TransformStore. The handle is generation-checked on every access; a view
+// outliving its transform raises a Lua error.
+template <typename T> struct TransformRef {
+  std::shared_ptr<TransformStore> store;
+  TransformHandle handle;
+  std::vector<T> &(TransformStore::*array)();
+
+  T &value() const {
+    if (!store->is_alive(handle)) {
+      throw sol::error("transform no longer exists");
+    }
+    return (store.get()->*array)()[store->dense_index(handle)];
+  }
+  void mark_dirty() const { store->mark_dirty(store->dense_index(handle)); }
+};
+
+using Vec3Ref = TransformRef<glm::vec3>;
+using QuatRef = TransformRef<glm::quat>;
+
+template <typename T>
+TransformRef<T> make_ref(const TransformComponent &transform,
+                         std::vector<T> &(TransformStore::*array)()) {
+  return TransformRef<T>{transform.get_shared_store(), transform.get_handle(),
+                         array};
+}
+
+// A read/write Lua property for one float field of a TransformRef.
+template <typename T> auto field(float T::*member) {
+  return sol::property(
+      [member](const TransformRef<T> &ref) { return ref.value().*member; },
+      [member](const TransformRef<T> &ref, float v) {
+        ref.value().*member = v;
+        ref.mark_dirty();
+      });
+}
+
+// Property setters take either a plain value or another TransformRef, so
+// `a.transform.position = b.transform.position` copies the value.
+template <typename T>
+void assign(TransformComponent &self, const sol::object &value,
+            void (TransformComponent::*setter)(const T &)) {
+  if (value.is<T>()) {
+    (self.*setter)(value.as<T>());
+  } else if (value.is<TransformRef<T>>()) {
+    (self.*setter)(value.as<TransformRef<T>>().value());
+  } else {
+    throw sol::error("transform property expects a matching value");
+  }
+}
+
+// A component handed to Lua. Components live until their object is
+// destroyed, so the owner is held weakly and checked on every access; a
+// reference outliving its object raises a Lua error instead of touching
+// freed pool memory.
+template <typename T> struct ComponentRef {
+  std::weak_ptr<SceneObject> owner;
+  T *component;
+
+  bool is_valid() const { return !owner.expired(); }
+  T &get() const {
+    if (owner.expired()) {
+      throw sol::error("component's object no longer exists");
+    }
+    return *component;
+  }
+};
+
+template <typename T, typename... Args>
+ComponentRef<T> add_component_ref(SceneObject &self, Args... args) {
+  T *component = self.add_component<T>(args...);
+  return ComponentRef<T>{self.weak_from_this(), component};
+}
+
+// A read/write Lua property for one field of a referenced component.
+template <typename T, typename V> auto component_field(V T::*member) {
+  return sol::property(
+      [member](const ComponentRef<T> &ref) { return ref.get().*member; },
+      [member](const ComponentRef<T> &ref, V v) { ref.get().*member = v; });
+}
+} // namespace
+
 void ScriptingManager::init() {
   if (s_lua_state) {
     Log::warn("ScriptingManager already initialized.");
@@ -156,6 +247,8 @@ void ScriptingManager::bind_settings_types() {
       // GraphicsRenderer settings
       "graphics_main_shader_name", &Config::graphics_main_shader_name,
       "graphics_canvas_shader_name", &Config::graphics_canvas_shader_name,
+      "graphics_gpu_driven", &Config::graphics_gpu_driven,
+      "graphics_cull_shader_name", &Config::graphics_cull_shader_name,
 
       // CanvasRenderer settings
       "canvas_shader_name", &Config::canvas_shader_name,
@@ -168,12 +261,52 @@ void ScriptingManager::bind_settings_types() {
 void ScriptingManager::bind_context_types() {
   s_lua_state->new_usertype<ScriptingContext>(
       "ScriptingContext", "scene", &ScriptingContext::scene, "renderer",
-      &ScriptingContext::renderer);
+      &ScriptingContext::renderer, "capture", &ScriptingContext::capture);
+
+  // From Lua or the console: App.capture:start(120, "y4m", "captures/run")
+  s_lua_state->new_usertype<FrameCapture>(
+      "FrameCapture", "start",
+      [](FrameCapture &self, unsigned int frames, const std::string &format,
+         const std::string &path) {
+        CaptureFormat parsed;
+        if (!FrameCapture::parse_format(format, parsed)) {
+          Log::warn("Unknown capture format '" + format +
+                    "'. Use png, raw or y4m.");
+          return false;
+        }
+        return self.start(frames, parsed, path);
+      },
+      "stop", &FrameCapture::stop, "is_capturing",
+      &FrameCapture::is_capturing);
 }
 
 void ScriptingManager::bind_renderer_types() {
   s_lua_state->new_usertype<IRenderer>("Renderer", "execute_command",
                                        &IRenderer::execute_command);
+
+  // GPU pass timings, e.g. print(GpuProfiler.report()) from the console.
+  s_lua_state->new_usertype<GpuProfiler::PassStats>(
+      "GpuPassStats", "name", &GpuProfiler::PassStats::name, "depth",
+      &GpuProfiler::PassStats::depth, "last_ms",
+      &GpuProfiler::PassStats::last_ms, "min_ms",
+      &GpuProfiler::PassStats::min_ms, "avg_ms",
+      &GpuProfiler::PassStats::avg_ms, "max_ms",
+      &GpuProfiler::PassStats::max_ms, "samples",
+      &GpuProfiler::PassStats::samples);
+  auto gpu_profiler_type =
+      s_lua_state->new_usertype<GpuProfiler>("GpuProfiler");
+  gpu_profiler_type["stats"] = [] {
+    return sol::as_table(GpuProfiler::get_stats());
+  };
+  gpu_profiler_type["report"] = &GpuProfiler::get_report;
+  gpu_profiler_type["dump"] = &GpuProfiler::write_json;
+  gpu_profiler_type["reset"] = &GpuProfiler::reset;
+  gpu_profiler_type["set_enabled"] = &GpuProfiler::set_enabled;
+
+  // CPU zones as a Chrome trace: Profiler.write_trace("trace.json")
+  auto profiler_type = s_lua_state->new_usertype<Profiler>("Profiler");
+  profiler_type["write_trace"] = &Profiler::write_chrome_trace;
+  profiler_type["clear"] = &Profiler::clear;
 }
 
 void ScriptingManager::bind_utility_types() {
@@ -202,15 +335,57 @@ void ScriptingManager::bind_utility_types() {
 
 void ScriptingManager::bind_component_types() {
   // TransformComponent
+  // Properties are TransformVec3/TransformQuat views into the owning
+  // store; `.value` (or arithmetic) gives a plain vec3 copy.
+  s_lua_state->new_usertype<Vec3Ref>(
+      "TransformVec3", sol::no_constructor, "x", field(&glm::vec3::x), "y",
+      field(&glm::vec3::y), "z", field(&glm::vec3::z), "value",
+      sol::readonly_property([](const Vec3Ref &ref) { return ref.value(); }),
+      sol::meta_function::multiplication,
+      [](const Vec3Ref &ref, float s) { return ref.value() * s; },
+      sol::meta_function::addition,
+      [](const Vec3Ref &ref, const glm::vec3 &v) { return ref.value() + v; });
+  s_lua_state->new_usertype<QuatRef>(
+      "TransformQuat", sol::no_constructor, "x", field(&glm::quat::x), "y",
+      field(&glm::quat::y), "z", field(&glm::quat::z), "w",
+      field(&glm::quat::w));
+
   s_lua_state->new_usertype<TransformComponent>(
-      "TransformComponent", "position", &TransformComponent::position,
-      "rotation", &TransformComponent::rotation, "scale",
-      &TransformComponent::scale);
+      "TransformComponent", sol::no_constructor, "position",
+      sol::property(
+          [](const TransformComponent &self) {
+            return make_ref(self, &TransformStore::positions);
+          },
+          [](TransformComponent &self, const sol::object &value) {
+            assign(self, value, &TransformComponent::set_position);
+          }),
+      "rotation",
+      sol::property(
+          [](const TransformComponent &self) {
+            return make_ref(self, &TransformStore::rotations);
+          },
+          [](TransformComponent &self, const sol::object &value) {
+            assign(self, value, &TransformComponent::set_rotation);
+          }),
+      "scale",
+      sol::property(
+          [](const TransformComponent &self) {
+            return make_ref(self, &TransformStore::scales);
+          },
+          [](TransformComponent &self, const sol::object &value) {
+            assign(self, value, &TransformComponent::set_scale);
+          }));
 
   // CameraComponent
   s_lua_state->new_usertype<CameraComponent>(
       "CameraComponent",
       sol::constructors<CameraComponent(float, float, float)>());
+  s_lua_state->new_usertype<ComponentRef<CameraComponent>>(
+      "CameraComponentRef", sol::no_constructor, "valid",
+      sol::readonly_property(&ComponentRef<CameraComponent>::is_valid), "fov",
+      component_field(&CameraComponent::fov), "near_plane",
+      component_field(&CameraComponent::near_plane), "far_plane",
+      component_field(&CameraComponent::far_plane));
 
   // PropertyAnimatorComponent
   s_lua_state->new_usertype<PropertyAnimatorComponent>(
@@ -240,9 +415,14 @@ void ScriptingManager::bind_scene_types() {
                      [](const std::shared_ptr<Mesh> &mesh) {
                        return std::make_shared<SceneObject>(mesh);
                      }),
-      "transform", &SceneObject::transform, "mesh", &SceneObject::mesh,
+      "transform",
+      sol::property([](SceneObject &self) -> TransformComponent & {
+        return self.transform;
+      }),
+      "mesh", sol::property(&SceneObject::get_mesh, &SceneObject::set_mesh),
+      "set_parent", &SceneObject::set_parent,
       "add_camera_component",
-      &SceneObject::add_component<CameraComponent, float, float, float>,
+      &add_component_ref<CameraComponent, float, float, float>,
       "add_rotation_animator",
       [](SceneObject &self, const glm::vec3 &axis, float degrees_per_second) {
         self.add_component<PropertyAnimatorComponent>(
@@ -263,7 +443,18 @@ void ScriptingManager::bind_scene_types() {
   s_lua_state->new_usertype<Scene>(
       "Scene", "add_object", &Scene::add_object, "set_active_camera",
       &Scene::set_active_camera, "get_active_camera",
-      &Scene::get_active_camera);
+      &Scene::get_active_camera,
+      // Spatial queries return arrays of SceneObjects; raycast returns the
+      // hit object and its distance, or nil.
+      "query_sphere",
+      [](const Scene &self, const glm::vec3 &center, float radius) {
+        return sol::as_table(self.query_sphere(center, radius));
+      },
+      "query_box",
+      [](const Scene &self, const glm::vec3 &min, const glm::vec3 &max) {
+        return sol::as_table(self.query_box(min, max));
+      },
+      "raycast", &Scene::raycast);
 }
 
 void ScriptingManager::run_command(const std::string &command) {
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdio>
+
+// Minimal assertions for the test executables. A failed CHECK prints where
+// it failed and the test carries on; check_result() is main()'s return
+// value, non-zero if anything failed.
+inline int &check_failures() {
+  static int s_failures = 0;
+  return s_failures;
+}
+
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,    \
+                   #condition);                                                \
+      check_failures()++;                                                      \
+    }                                                                          \
+  } while (false)
+
+// main()'s return value when the machine can't run a test (e.g. no GL
+// context); ctest reports the test as skipped.
+constexpr int SKIP_TEST = 77;
+
+inline int check_result() {
+  if (check_failures() > 0) {
+    std::fprintf(stderr, "%d check(s) failed\n", check_failures());
+    return 1;
+  }
+  return 0;
+}
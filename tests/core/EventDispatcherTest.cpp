@@ -0,0 +1,54 @@
+#include "Check.h"
+#include "core/events/AppEvent.h"
+#include "core/events/EventDispatcher.h"
+#include "core/events/MouseEvent.h"
+#include <string>
+
+namespace {
+// What subscribers saw, in dispatch order: "m<x>:<dx>" per move, "p" per
+// press, "r<width>" per resize.
+std::string s_log;
+
+void test_keep_all_events_split_runs() {
+  s_log.clear();
+  EventDispatcher::post<MouseMovedEvent>(1.0f, 0.0f, 1.0f, 0.0f);
+  EventDispatcher::post<MouseButtonPressedEvent>(0);
+  EventDispatcher::post<MouseMovedEvent>(3.0f, 0.0f, 2.0f, 0.0f);
+  EventDispatcher::dispatch_events();
+  CHECK(s_log == "m1:1 p m3:2 ");
+}
+
+void test_runs_coalesce() {
+  s_log.clear();
+  EventDispatcher::post<MouseMovedEvent>(1.0f, 0.0f, 1.0f, 0.0f);
+  EventDispatcher::post<MouseMovedEvent>(2.0f, 0.0f, 1.0f, 0.0f);
+  EventDispatcher::post<WindowResizeEvent>(100u, 50u);
+  EventDispatcher::post<MouseMovedEvent>(4.0f, 0.0f, 2.0f, 0.0f);
+  EventDispatcher::post<WindowResizeEvent>(200u, 50u);
+  EventDispatcher::post<MouseButtonPressedEvent>(0);
+  EventDispatcher::post<MouseMovedEvent>(5.0f, 0.0f, 1.0f, 0.0f);
+  EventDispatcher::post<MouseMovedEvent>(7.0f, 0.0f, 2.0f, 0.0f);
+  EventDispatcher::dispatch_events();
+  // Before the press: one move carrying all three deltas and the latest
+  // resize. After it: one move of the two that followed.
+  CHECK(s_log == "m4:4 r200 p m7:3 ");
+}
+} // namespace
+
+int main() {
+  auto moves = EventDispatcher::subscribe<MouseMovedEvent>(
+      [](MouseMovedEvent &event) {
+        s_log += "m" + std::to_string(static_cast<int>(event.get_x())) + ":" +
+                 std::to_string(static_cast<int>(event.get_delta_x())) + " ";
+      });
+  auto presses = EventDispatcher::subscribe<MouseButtonPressedEvent>(
+      [](MouseButtonPressedEvent &) { s_log += "p "; });
+  auto resizes = EventDispatcher::subscribe<WindowResizeEvent>(
+      [](WindowResizeEvent &event) {
+        s_log += "r" + std::to_string(event.get_width()) + " ";
+      });
+
+  test_keep_all_events_split_runs();
+  test_runs_coalesce();
+  return check_result();
+}
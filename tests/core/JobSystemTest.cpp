@@ -0,0 +1,54 @@
+#include "Check.h"
+#include "core/JobSystem.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+// Runs enough slow chunks that the workers have to pick some up, and checks
+// every index ran exactly once.
+void test_parallel_for_spreads_work() {
+  constexpr size_t COUNT = 64;
+  std::vector<std::atomic<int>> runs(COUNT);
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+
+  JobSystem::parallel_for(COUNT, 1, [&](size_t begin, size_t end) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      threads.insert(std::this_thread::get_id());
+    }
+    for (size_t i = begin; i < end; ++i) {
+      runs[i]++;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  });
+
+  for (size_t i = 0; i < COUNT; ++i) {
+    CHECK(runs[i] == 1);
+  }
+  CHECK(threads.size() > 1);
+}
+
+void test_small_range_runs_inline() {
+  std::thread::id caller = std::this_thread::get_id();
+  std::thread::id ran_on;
+  JobSystem::parallel_for(10, 16, [&](size_t begin, size_t end) {
+    CHECK(begin == 0 && end == 10);
+    ran_on = std::this_thread::get_id();
+  });
+  CHECK(ran_on == caller);
+}
+} // namespace
+
+int main() {
+  JobSystem::init(3);
+  CHECK(JobSystem::get_worker_count() == 3);
+  test_parallel_for_spreads_work();
+  test_small_range_runs_inline();
+  JobSystem::shutdown();
+  return check_result();
+}
@@ -0,0 +1,90 @@
+#include "Check.h"
+#include "core/Window.h"
+#include "graphics/Frustum.h"
+#include "graphics/GeometryArena.h"
+#include "graphics/IndirectDrawPass.h"
+#include "scene/Scene.h"
+#include "utils/ResourceManager.h"
+#include <algorithm>
+#include <cstdio>
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+// Smoke test for the GPU-driven path: renders a scene headless and checks
+// how many instances the cull shader let through per mesh.
+void add_objects(Scene &scene, const std::shared_ptr<Mesh> &mesh, int count,
+                 const glm::vec3 &first, const glm::vec3 &step) {
+  for (int i = 0; i < count; ++i) {
+    auto object = std::make_shared<SceneObject>(mesh);
+    object->transform.set_position(first + step * static_cast<float>(i));
+    scene.add_object(object);
+  }
+}
+
+std::vector<uint32_t> draw(IndirectDrawPass &pass, const Scene &scene,
+                           const glm::mat4 &view, Shader &shader) {
+  const glm::mat4 projection =
+      glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f);
+  shader.use();
+  pass.draw(scene, Frustum::from_matrix(projection * view), shader);
+  std::vector<uint32_t> counts = pass.read_instance_counts();
+  // Command order depends on where the meshes landed in the arena.
+  std::sort(counts.begin(), counts.end());
+  return counts;
+}
+} // namespace
+
+int main() {
+  Window window;
+  if (!window.init_headless(64, 64, 0) || !IndirectDrawPass::is_supported()) {
+    std::fprintf(stderr, "No headless OpenGL 4.3 context; skipping.\n");
+    return SKIP_TEST;
+  }
+  auto cull = ResourceManager::load_shader("cull", ShaderType::Compute,
+                                           {"shaders/cull.comp"});
+  auto shader = ResourceManager::load_shader(
+      "default", ShaderType::Graphics,
+      {"shaders/shader.vert", "shaders/shader.frag"});
+  CHECK(cull && shader);
+  if (!cull || !shader) {
+    return check_result();
+  }
+
+  {
+    IndirectDrawPass pass;
+    CHECK(pass.init(cull));
+
+    // Looking down -z from the origin: 10 cubes and 3 spheres ahead, 5 cubes
+    // behind and 4 spheres far off to the side.
+    Scene scene;
+    auto cube = ResourceManager::get_primitive("cube");
+    auto sphere = ResourceManager::get_primitive("sphere");
+    add_objects(scene, cube, 10, glm::vec3(-4.5f, 0.0f, -20.0f),
+                glm::vec3(1.0f, 0.0f, 0.0f));
+    add_objects(scene, cube, 5, glm::vec3(0.0f, 0.0f, 10.0f),
+                glm::vec3(0.0f, 0.0f, 2.0f));
+    add_objects(scene, sphere, 3, glm::vec3(0.0f, 2.0f, -10.0f),
+                glm::vec3(0.0f, 0.0f, -3.0f));
+    add_objects(scene, sphere, 4, glm::vec3(500.0f, 0.0f, -10.0f),
+                glm::vec3(0.0f, 5.0f, 0.0f));
+    scene.update(0.0f);
+    CHECK(pass.get_object_count() == 0); // Built on the first draw
+
+    const glm::mat4 ahead(1.0f);
+    CHECK((draw(pass, scene, ahead, *shader) == std::vector<uint32_t>{3, 10}));
+    CHECK(pass.get_object_count() == 22);
+
+    // Counts are reset every frame, not accumulated.
+    CHECK((draw(pass, scene, ahead, *shader) == std::vector<uint32_t>{3, 10}));
+
+    // Turned around, only the cubes behind are in view.
+    const glm::mat4 behind =
+        glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), glm::vec3(0, 1, 0));
+    CHECK((draw(pass, scene, behind, *shader) == std::vector<uint32_t>{0, 5}));
+  }
+
+  ResourceManager::clear();
+  GeometryArena::shutdown();
+  return check_result();
+}
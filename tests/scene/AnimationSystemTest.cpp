@@ -0,0 +1,80 @@
+#include "Check.h"
+#include "core/JobSystem.h"
+#include "scene/AnimationSystem.h"
+#include "scene/TransformStore.h"
+#include <cmath>
+
+namespace {
+// Enough tracks for several chunks per kind.
+constexpr size_t TRANSFORM_COUNT = 4 * AnimationSystem::TRACK_CHUNK_SIZE + 7;
+
+struct Fixture {
+  TransformStore transforms;
+  AnimationSystem animations;
+  std::vector<TransformHandle> handles;
+
+  // `shared_target` adds a second rotation to transform 0, so rotations have
+  // to run serially.
+  explicit Fixture(bool shared_target) {
+    for (size_t i = 0; i < TRANSFORM_COUNT; ++i) {
+      const float f = static_cast<float>(i);
+      TransformHandle handle = transforms.create(glm::vec3(f, 0.0f, 0.0f));
+      handles.push_back(handle);
+      animations.add_rotation(handle, glm::vec3(0.0f, 1.0f, 0.0f),
+                              10.0f + f * 0.01f);
+      animations.add_position(handle, glm::vec3(f, 0.0f, 0.0f),
+                              glm::vec3(0.0f, 1.0f, 0.0f), 1.0f + f * 0.001f,
+                              2.0f);
+      animations.add_scale(handle, glm::vec3(1.0f), 0.5f, 0.5f, 1.5f);
+    }
+    if (shared_target) {
+      animations.add_rotation(handles[0], glm::vec3(1.0f, 0.0f, 0.0f), 45.0f);
+    }
+  }
+
+  void run(int frames) {
+    for (int frame = 1; frame <= frames; ++frame) {
+      animations.update(transforms, 1.0f / 60.0f, frame / 60.0);
+    }
+  }
+};
+
+bool near(float a, float b) { return std::fabs(a - b) <= 1e-5f; }
+
+// The same tracks must produce the same transforms whether they ran inline
+// or split across workers.
+void check_same(Fixture &serial, Fixture &parallel) {
+  for (size_t i = 0; i < TRANSFORM_COUNT; ++i) {
+    const uint32_t a = serial.transforms.dense_index(serial.handles[i]);
+    const uint32_t b = parallel.transforms.dense_index(parallel.handles[i]);
+    const glm::quat &qa = serial.transforms.rotations()[a];
+    const glm::quat &qb = parallel.transforms.rotations()[b];
+    CHECK(near(qa.x, qb.x) && near(qa.y, qb.y) && near(qa.z, qb.z) &&
+          near(qa.w, qb.w));
+    const glm::vec3 &pa = serial.transforms.positions()[a];
+    const glm::vec3 &pb = parallel.transforms.positions()[b];
+    CHECK(near(pa.x, pb.x) && near(pa.y, pb.y) && near(pa.z, pb.z));
+    const glm::vec3 &sa = serial.transforms.scales()[a];
+    const glm::vec3 &sb = parallel.transforms.scales()[b];
+    CHECK(near(sa.x, sb.x) && near(sa.y, sb.y) && near(sa.z, sb.z));
+  }
+}
+
+void test_parallel_matches_serial(bool shared_target) {
+  Fixture serial(shared_target);
+  serial.run(30);
+
+  JobSystem::init(3);
+  Fixture parallel(shared_target);
+  parallel.run(30);
+  JobSystem::shutdown();
+
+  check_same(serial, parallel);
+}
+} // namespace
+
+int main() {
+  test_parallel_matches_serial(false);
+  test_parallel_matches_serial(true);
+  return check_result();
+}
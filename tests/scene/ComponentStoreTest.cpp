@@ -0,0 +1,140 @@
+#include "Check.h"
+#include "scene/ComponentStore.h"
+
+namespace {
+struct Counter : Component {
+  int updates = 0;
+  void update(float) override { updates++; }
+};
+
+// Pools only compare scene pointers, so any two distinct addresses will do.
+int s_scene_storage[2];
+const Scene *const SCENE_A =
+    reinterpret_cast<const Scene *>(&s_scene_storage[0]);
+const Scene *const SCENE_B =
+    reinterpret_cast<const Scene *>(&s_scene_storage[1]);
+
+template <typename T>
+void update_all(ComponentPool<T> &pool, const Scene *scene) {
+  pool.begin_updates();
+  pool.update_range(scene, 0, pool.live_count(scene), 0.0f);
+  pool.end_updates();
+}
+
+// On its first update, destroys `victim` and adds a component to its scene.
+struct Spawner : Component {
+  static ComponentPool<Spawner> *s_pool;
+  static int s_total_updates;
+  uint32_t victim = ~0u;
+  int updates = 0;
+  void update(float) override {
+    s_total_updates++;
+    if (updates++ == 0 && victim != ~0u) {
+      s_pool->destroy(victim);
+      s_pool->create(SCENE_A);
+    }
+  }
+};
+ComponentPool<Spawner> *Spawner::s_pool = nullptr;
+int Spawner::s_total_updates = 0;
+
+// Only ever created from Grower::update(), so its pool is added mid-pass.
+struct Late : Counter {};
+
+struct Grower : Component {
+  static ComponentStore *s_store;
+  Late *added = nullptr;
+  void update(float) override {
+    added = s_store->pool<Late>().create(SCENE_A).first;
+  }
+};
+ComponentStore *Grower::s_store = nullptr;
+
+void test_updates_only_the_scenes_components() {
+  ComponentPool<Counter> pool;
+  auto [a0, a0_slot] = pool.create(SCENE_A);
+  auto [b0, b0_slot] = pool.create(SCENE_B);
+  auto [a1, a1_slot] = pool.create(SCENE_A);
+  auto [none, none_slot] = pool.create(nullptr);
+
+  CHECK(pool.live_count(SCENE_A) == 2);
+  CHECK(pool.live_count(SCENE_B) == 1);
+  update_all(pool, SCENE_A);
+  CHECK(a0->updates == 1 && a1->updates == 1);
+  CHECK(b0->updates == 0 && none->updates == 0);
+}
+
+void test_destroy_and_move_keep_lists_dense() {
+  ComponentPool<Counter> pool;
+  Counter *a[4];
+  uint32_t slots[4];
+  for (int i = 0; i < 4; ++i) {
+    auto [component, slot] = pool.create(SCENE_A);
+    a[i] = component;
+    slots[i] = slot;
+  }
+
+  pool.destroy(slots[1]);
+  pool.set_scene(slots[2], SCENE_B);
+  CHECK(pool.live_count(SCENE_A) == 2);
+  CHECK(pool.live_count(SCENE_B) == 1);
+
+  update_all(pool, SCENE_A);
+  CHECK(a[0]->updates == 1 && a[3]->updates == 1 && a[2]->updates == 0);
+  update_all(pool, SCENE_B);
+  CHECK(a[2]->updates == 1);
+
+  // The freed slot is reused and joins its new scene's list.
+  auto [reused, reused_slot] = pool.create(SCENE_B);
+  CHECK(reused_slot == slots[1]);
+  CHECK(pool.live_count(SCENE_B) == 2);
+  update_all(pool, SCENE_B);
+  CHECK(reused->updates == 1 && a[2]->updates == 2);
+}
+void test_add_and_destroy_during_update() {
+  ComponentPool<Spawner> pool;
+  Spawner::s_pool = &pool;
+  Spawner *a[4];
+  uint32_t slots[4];
+  for (int i = 0; i < 4; ++i) {
+    auto [component, slot] = pool.create(SCENE_A);
+    a[i] = component;
+    slots[i] = slot;
+  }
+  // The second destroys itself and the third the already-updated first; each
+  // used to swap the last component into a visited index, skipping it.
+  a[1]->victim = slots[1];
+  a[2]->victim = slots[0];
+
+  Spawner::s_total_updates = 0;
+  update_all(pool, SCENE_A);
+  // The four update once each; the two additions wait for the next pass.
+  CHECK(Spawner::s_total_updates == 4);
+  CHECK(a[2]->updates == 1 && a[3]->updates == 1);
+  CHECK(pool.live_count(SCENE_A) == 4);
+
+  Spawner::s_total_updates = 0;
+  update_all(pool, SCENE_A);
+  CHECK(Spawner::s_total_updates == 4);
+  CHECK(a[2]->updates == 2 && a[3]->updates == 2);
+}
+
+void test_update_adding_a_new_component_type() {
+  ComponentStore store;
+  Grower::s_store = &store;
+  Grower *grower = store.pool<Grower>().create(SCENE_A).first;
+
+  store.update(*SCENE_A, 0.0f);
+  CHECK(store.pool<Late>().live_count(SCENE_A) == 1);
+  // The pass that created the pool goes on to update it.
+  CHECK(grower->added && grower->added->updates == 1);
+}
+} // namespace
+
+int main() {
+  test_updates_only_the_scenes_components();
+  test_destroy_and_move_keep_lists_dense();
+  test_add_and_destroy_during_update();
+  test_update_adding_a_new_component_type();
+  return check_result();
+}